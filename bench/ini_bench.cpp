@@ -0,0 +1,443 @@
+/**
+ * @file ini_bench.cpp
+ * @brief @ref Ini クラスの解析・読取・書込性能を計測するベンチマーク
+ *
+ * 以下のようにビルドする。(依存ライブラリはない)
+ *
+ *     g++ -O2 -std=c++17 -pthread bench/ini_bench.cpp -o ini_bench
+ *
+ * 使い方:
+ *
+ *     ./ini_bench                      1K, 100K行のファイルで計測する
+ *     ./ini_bench --large              10M行のファイルも計測する
+ *     ./ini_bench --lines 5000,20000   計測する行数を指定する
+ *     ./ini_bench --min-time 0.5       1計測あたりの最小計測時間(秒)を指定する
+ */
+
+#include "../ini.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+std::atomic<unsigned long long> allocation_count(0);
+
+// 計測対象のメモリ確保回数を数えるため、グローバルの operator new / delete を置き換える。
+void* counted_allocate(std::size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void counted_deallocate(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return counted_allocate(size); }
+void* operator new[](std::size_t size) { return counted_allocate(size); }
+void operator delete(void* ptr) noexcept { counted_deallocate(ptr); }
+void operator delete[](void* ptr) noexcept { counted_deallocate(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { counted_deallocate(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { counted_deallocate(ptr); }
+
+namespace
+{
+
+struct Options
+{
+    std::vector<std::size_t> lines;
+    double min_time;
+};
+
+/**
+ * @struct Layout
+ * @brief 生成するiniファイルの形状
+ */
+struct Layout
+{
+    const char* name;
+    std::size_t fields_per_section;
+};
+
+const Layout layouts[] = {
+    { "many-sections", 10 },
+    { "wide-sections", 0 },   // 0の場合は行数によらず4セクションとする
+};
+
+struct Key
+{
+    std::string section;
+    std::string field;
+};
+
+/**
+ * @struct Fixture
+ * @brief 生成したiniファイルと、型毎の読取対象キー
+ */
+struct Fixture
+{
+    std::string path;
+    std::size_t lines;
+    std::size_t bytes;
+    std::vector<Key> int_keys;
+    std::vector<Key> double_keys;
+    std::vector<Key> bool_keys;
+    std::vector<Key> str_keys;
+    std::vector<std::string> sections;
+};
+
+Fixture generate(const Layout& layout, const std::size_t lines)
+{
+    Fixture fixture;
+    fixture.path = std::string("ini_bench_") + layout.name + "_" + std::to_string(lines) + ".ini";
+    fixture.lines = lines;
+
+    const std::size_t per_section = layout.fields_per_section != 0 ? layout.fields_per_section : (lines / 4 + 1);
+    std::string text;
+    text.reserve(lines * 24);
+
+    std::size_t line = 0;
+    std::size_t section = 0;
+    while (line < lines)
+    {
+        const std::string section_name = "SECTION" + std::to_string(section++);
+        text += "[" + section_name + "]\n";
+        fixture.sections.push_back(section_name);
+        ++line;
+        for (std::size_t i = 0; i < per_section && line < lines; ++i, ++line)
+        {
+            const std::string field_name = "FIELD" + std::to_string(i);
+            text += field_name + " = ";
+            Key key = { section_name, field_name };
+            switch (line % 4)
+            {
+            case 0: text += std::to_string(line); fixture.int_keys.push_back(key); break;
+            case 1: text += std::to_string(line) + ".25"; fixture.double_keys.push_back(key); break;
+            case 2: text += (line % 8 == 2) ? "true" : "FALSE"; fixture.bool_keys.push_back(key); break;
+            default: text += "value of line " + std::to_string(line); fixture.str_keys.push_back(key); break;
+            }
+            text += '\n';
+        }
+    }
+
+    std::FILE* file = std::fopen(fixture.path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        std::perror(fixture.path.c_str());
+        std::exit(1);
+    }
+    std::fwrite(text.data(), 1, text.size(), file);
+    std::fclose(file);
+    fixture.bytes = text.size();
+    return fixture;
+}
+
+struct Result
+{
+    unsigned long long iterations;
+    double seconds;
+    unsigned long long allocations;
+};
+
+/**
+ * @fn measure
+ * @brief 最小計測時間に達するまで処理を繰り返し、所要時間とメモリ確保回数を計測する
+ */
+Result measure(const std::function<void(unsigned long long)>& body, const double min_time, const unsigned long long max_iterations)
+{
+    typedef std::chrono::steady_clock Clock;
+    Result result = { 0, 0.0, 0 };
+    const unsigned long long allocations = allocation_count.load();
+    const Clock::time_point start = Clock::now();
+    while (result.iterations < max_iterations)
+    {
+        body(result.iterations++);
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (result.seconds >= min_time)
+            break;
+    }
+    result.allocations = allocation_count.load() - allocations;
+    return result;
+}
+
+void report(const char* layout, const Fixture& fixture, const char* name, const Result& result, const std::size_t bytes_per_iteration)
+{
+    const double per_second = result.iterations / result.seconds;
+    std::printf("%-14s %10zu  %-24s %14.1f ops/s %10.3f us/op", layout, fixture.lines, name, per_second, 1e6 / per_second);
+    if (bytes_per_iteration != 0)
+        std::printf(" %9.1f MB/s", per_second * bytes_per_iteration / (1024.0 * 1024.0));
+    else
+        std::printf(" %14s", "");
+    std::printf(" %10.2f allocs/op\n", static_cast<double>(result.allocations) / result.iterations);
+}
+
+template <class F>
+void bench_lookup(const char* layout, const Fixture& fixture, const char* name, const std::vector<Key>& keys,
+                  const double min_time, const unsigned long long max_iterations, F read)
+{
+    if (keys.empty())
+        return;
+    std::mt19937 rng(42);
+    std::vector<std::size_t> order(4096);
+    for (auto& index : order)
+        index = rng() % keys.size();
+
+    Result result = measure([&](unsigned long long i) {
+        const Key& key = keys[order[i % order.size()]];
+        read(key);
+    }, min_time, max_iterations);
+    report(layout, fixture, name, result, 0);
+}
+
+/**
+ * @struct NodeDocument
+ * @brief 比較対象とする、セクション・フィールド毎にノードを確保する連想配列によるドキュメント
+ * @note 同一のセクション・フィールドが複数存在する場合は @ref Ini と同じく最初のものを採用する。
+ */
+struct NodeDocument : Ini::Handler
+{
+    std::map<std::string, std::map<std::string, std::string>> sections;
+
+    bool on_field(const Ini::StringRef& section, const Ini::StringRef& field, const Ini::StringRef& value) override
+    {
+        sections[std::string(section.data(), section.size())].emplace(std::string(field.data(), field.size()), std::string(value.data(), value.size()));
+        return true;
+    }
+};
+
+void run(const Layout& layout, const std::size_t lines, const Options& options)
+{
+    const Fixture fixture = generate(layout, lines);
+    const double min_time = options.min_time;
+    volatile long long sink = 0;
+
+    // 解析
+    {
+        Result result = measure([&](unsigned long long) { Ini ini(fixture.path); ini.load(); }, min_time, 1000000);
+        report(layout.name, fixture, "parse", result, fixture.bytes);
+    }
+    {
+        Result result = measure([&](unsigned long long) { Ini ini(fixture.path); ini.set_memory_map(true).load(); }, min_time, 1000000);
+        report(layout.name, fixture, "parse (mmap)", result, fixture.bytes);
+    }
+    {
+        Result result = measure([&](unsigned long long) { Ini ini(fixture.path); ini.set_parallel_load(0).load(); }, min_time, 1000000);
+        report(layout.name, fixture, "parse (parallel)", result, fixture.bytes);
+    }
+    {
+        const std::string cache_path = fixture.path + ".cache";
+        Ini(fixture.path).set_cache_path(cache_path).load();
+        Result result = measure([&](unsigned long long) { Ini ini(fixture.path); ini.set_cache_path(cache_path).load(); }, min_time, 1000000);
+        report(layout.name, fixture, "parse (cache)", result, fixture.bytes);
+        std::remove(cache_path.c_str());
+    }
+    {
+        Result result = measure([&](unsigned long long) { Ini ini(fixture.path); ini.set_lazy_load(true).load(); }, min_time, 1000000);
+        report(layout.name, fixture, "parse (lazy)", result, fixture.bytes);
+    }
+    {
+        const Key& key = fixture.int_keys[fixture.int_keys.size() / 2];
+        Result result = measure([&](unsigned long long) {
+            Ini ini(fixture.path);
+            ini.set_lazy_load(true).set_memory_map(true).load();
+            sink = sink + ini.read_int(key.section, key.field, 0);
+        }, min_time, 1000000);
+        report(layout.name, fixture, "parse (lazy) + read_int", result, fixture.bytes);
+    }
+    {
+        struct Counter : Ini::Handler
+        {
+            std::size_t fields = 0;
+            bool on_field(const Ini::StringRef&, const Ini::StringRef&, const Ini::StringRef&) override { ++fields; return true; }
+        };
+        Result result = measure([&](unsigned long long) { Counter counter; Ini(fixture.path).parse(counter); }, min_time, 1000000);
+        report(layout.name, fixture, "parse (stream)", result, fixture.bytes);
+    }
+
+    {
+        Result result = measure([&](unsigned long long) { NodeDocument document; Ini(fixture.path).parse(document); }, min_time, 1000000);
+        report(layout.name, fixture, "parse (node map)", result, fixture.bytes);
+    }
+
+    // 読込済みドキュメントからの読取
+    Ini ini(fixture.path);
+    ini.load();
+    NodeDocument nodes;
+    ini.parse(nodes);
+    bench_lookup(layout.name, fixture, "read_int", fixture.int_keys, min_time, 100000000,
+                 [&](const Key& key) { sink = sink + ini.read_int(key.section, key.field, 0); });
+    bench_lookup(layout.name, fixture, "read_double", fixture.double_keys, min_time, 100000000,
+                 [&](const Key& key) { sink = sink + static_cast<long long>(ini.read_double(key.section, key.field, 0.0)); });
+    bench_lookup(layout.name, fixture, "read_bool", fixture.bool_keys, min_time, 100000000,
+                 [&](const Key& key) { sink = sink + ini.read_bool(key.section, key.field, false); });
+    bench_lookup(layout.name, fixture, "read_str", fixture.str_keys, min_time, 100000000,
+                 [&](const Key& key) { sink = sink + static_cast<long long>(ini.read_str(key.section, key.field, "").size()); });
+
+    bench_lookup(layout.name, fixture, "read_str (node map)", fixture.str_keys, min_time, 100000000, [&](const Key& key) {
+        auto section = nodes.sections.find(key.section);
+        if (section == nodes.sections.end())
+            return;
+        auto field = section->second.find(key.field);
+        sink = sink + static_cast<long long>(field != section->second.end() ? field->second.size() : 0);
+    });
+
+    // セクション単位の読取
+    {
+        std::vector<Key> section_keys;
+        for (const auto& section : fixture.sections)
+            section_keys.push_back(Key{ section, "" });
+        std::vector<std::pair<std::string, std::string>> fields;
+        bench_lookup(layout.name, fixture, "read_section", section_keys, min_time, 100000000,
+                     [&](const Key& key) { sink = sink + static_cast<long long>(ini.read_section(key.section, fields)); });
+        bench_lookup(layout.name, fixture, "read_section (node map)", section_keys, min_time, 100000000, [&](const Key& key) {
+            fields.clear();
+            auto section = nodes.sections.find(key.section);
+            if (section != nodes.sections.end())
+            {
+                for (const auto& field : section->second)
+                {
+                    if (!field.second.empty())
+                        fields.emplace_back(field.first, field.second);
+                }
+            }
+            sink = sink + static_cast<long long>(fields.size());
+        });
+    }
+
+    Ini::Reader reader = ini.reader();
+    bench_lookup(layout.name, fixture, "reader.read_int", fixture.int_keys, min_time, 100000000,
+                 [&](const Key& key) { sink = sink + reader.read_int(key.section, key.field, 0); });
+
+    // 予め解決した読取キーによる読取
+    {
+        std::vector<Ini::Key> handles;
+        for (const auto& key : fixture.int_keys)
+            handles.push_back(Ini::Key(key.section, key.field));
+        bench_lookup(layout.name, fixture, "read_int (key)", fixture.int_keys, min_time, 100000000,
+                     [&](const Key& key) { sink = sink + ini.read_int(handles[static_cast<std::size_t>(&key - fixture.int_keys.data())], 0); });
+        bench_lookup(layout.name, fixture, "reader.read_int (key)", fixture.int_keys, min_time, 100000000,
+                     [&](const Key& key) { sink = sink + reader.read_int(handles[static_cast<std::size_t>(&key - fixture.int_keys.data())], 0); });
+    }
+
+    // 識別番号による読取
+    {
+        std::vector<std::pair<Ini::Symbol, Ini::Symbol>> symbols;
+        for (const auto& key : fixture.int_keys)
+            symbols.push_back(std::make_pair(ini.intern(key.section), ini.intern(key.field)));
+        bench_lookup(layout.name, fixture, "read_int (symbol)", fixture.int_keys, min_time, 100000000, [&](const Key& key) {
+            const auto& symbol = symbols[static_cast<std::size_t>(&key - fixture.int_keys.data())];
+            sink = sink + ini.read_int(symbol.first, symbol.second, 0);
+        });
+    }
+
+    // 呼出し毎にファイルを走査する読取
+    Ini uncached(fixture.path);
+    bench_lookup(layout.name, fixture, "read_int (no load)", fixture.int_keys, min_time, 1000,
+                 [&](const Key& key) { sink = sink + uncached.read_int(key.section, key.field, 0); });
+
+    // 書込
+    {
+        Result result = measure([&](unsigned long long i) {
+            const Key& key = fixture.int_keys[i % fixture.int_keys.size()];
+            ini.write_int(key.section, key.field, static_cast<int>(i));
+        }, min_time, 1000);
+        report(layout.name, fixture, "write_int", result, fixture.bytes);
+    }
+    {
+        ini.set_in_place_write(true);
+        Result result = measure([&](unsigned long long i) {
+            const Key& key = fixture.int_keys[i % fixture.int_keys.size()];
+            ini.write_int(key.section, key.field, static_cast<int>(i % 10));
+        }, min_time, 1000);
+        ini.set_in_place_write(false);
+        report(layout.name, fixture, "write_int (in place)", result, fixture.bytes);
+    }
+    {
+        ini.set_write_behind(std::chrono::milliseconds(1000));
+        Result result = measure([&](unsigned long long i) {
+            const Key& key = fixture.int_keys[i % fixture.int_keys.size()];
+            ini.write_int(key.section, key.field, static_cast<int>(i % 10));
+        }, min_time, 1000);
+        ini.set_write_behind(std::chrono::milliseconds(0));
+        report(layout.name, fixture, "write_int (deferred)", result, fixture.bytes);
+    }
+    {
+        const std::size_t batch = 200;
+        Result result = measure([&](unsigned long long i) {
+            Ini::Transaction tx = ini.begin_transaction();
+            for (std::size_t j = 0; j < batch; ++j)
+            {
+                const Key& key = fixture.int_keys[(i * batch + j) % fixture.int_keys.size()];
+                tx.write_int(key.section, key.field, static_cast<int>(j));
+            }
+            tx.commit();
+        }, min_time, 1000);
+        report(layout.name, fixture, "transaction x200", result, fixture.bytes);
+    }
+
+    (void)sink;
+    std::remove(fixture.path.c_str());
+}
+
+std::vector<std::size_t> parse_lines(const char* arg)
+{
+    std::vector<std::size_t> lines;
+    const char* p = arg;
+    while (*p != '\0')
+    {
+        char* end;
+        lines.push_back(static_cast<std::size_t>(std::strtoull(p, &end, 10)));
+        p = (*end == ',') ? end + 1 : end;
+        if (end == p && *p != '\0')
+            break;
+    }
+    return lines;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    options.lines = { 1000, 100000 };
+    options.min_time = 0.2;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--large")
+            options.lines.push_back(10000000);
+        else if (arg == "--lines" && i + 1 < argc)
+            options.lines = parse_lines(argv[++i]);
+        else if (arg == "--min-time" && i + 1 < argc)
+            options.min_time = std::atof(argv[++i]);
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--large] [--lines N,N,...] [--min-time SECONDS]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::printf("%-14s %10s  %-24s %20s %16s %14s %20s\n", "layout", "lines", "benchmark", "throughput", "latency", "bandwidth", "allocations");
+    for (const std::size_t lines : options.lines)
+    {
+        for (const Layout& layout : layouts)
+            run(layout, lines, options);
+    }
+    return 0;
+}
@@ -0,0 +1,832 @@
+/**
+ * @file ini_fuzz.cpp
+ * @brief @ref Ini クラスの各解析方式の読取結果が一致することと、方式毎のスループットが低下していないことを検査するプログラム
+ *
+ * 以下のようにビルドする。(依存ライブラリはない)
+ *
+ *     g++ -O2 -std=c++17 -pthread bench/ini_fuzz.cpp -o ini_fuzz
+ *
+ * gzip形式の読込も検査する場合は -DINI_WITH_ZLIB を指定して -lz をリンクする。
+ * 走査関数はビルド時に選択されるため、-DINI_DISABLE_SIMD を指定したビルドでも実行し、スカラ実装を検査する。
+ *
+ * 使い方:
+ *
+ *     ./ini_fuzz                                ランダムに生成した入力で各方式の結果を比較する
+ *     ./ini_fuzz --iterations 2000 --seed 7     生成する入力の数と乱数の種を指定する
+ *     ./ini_fuzz --corpus a.ini --corpus b.ini  指定したファイルも入力として比較する
+ *     ./ini_fuzz --save-baseline baseline.txt   方式毎のスループットを記録する
+ *     ./ini_fuzz --baseline baseline.txt        記録と比較し、許容率を超えて低下した方式があれば終了コード1で終了する
+ *     ./ini_fuzz --tolerance 0.25               スループットの低下の許容率を指定する
+ *     ./ini_fuzz --min-time 0.5                 スループットの1計測あたりの最小計測時間(秒)を指定する
+ *
+ * 結果が一致しない入力は ini_fuzz_failure_N.ini として保存する。
+ * 併せて、遅延書込の内容がインスタンスの破棄・遅延書込の解除によって失われないことを検査する。
+ */
+
+#include "../ini.hpp"
+
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+/**
+ * @struct Config
+ * @brief 解析規則 (区切り文字・コメント行の先頭文字列)
+ */
+struct Config
+{
+    char separator;
+    std::vector<std::string> prefixes;
+
+    std::string describe() const
+    {
+        std::string text = "separator='";
+        text += separator;
+        text += "' prefixes={";
+        for (std::size_t i = 0; i < prefixes.size(); ++i)
+            text += (i == 0 ? "\"" : ", \"") + prefixes[i] + "\"";
+        return text + "}";
+    }
+
+    void apply(Ini& ini) const
+    {
+        ini.set_field_separator(separator).set_comment_prefix_list(prefixes);
+    }
+};
+
+struct Query
+{
+    std::string section;
+    std::string field;
+};
+
+/**
+ * @struct Outcome
+ * @brief 1つの入力に対する方式毎の読取結果
+ * @note 型変換を伴う読取に対応しない方式は typed を空とし、比較しない。
+ */
+struct Outcome
+{
+    std::vector<std::string> strings;
+    std::vector<std::string> typed;
+    std::vector<std::string> sections;
+};
+
+const char* const missing = "\x01missing";
+
+std::string describe_double(const double value)
+{
+    char text[64];
+    std::snprintf(text, sizeof(text), "%.17g", value);
+    return text;
+}
+
+/**
+ * @fn ask
+ * @brief 各問合せについて文字列・整数・浮動小数点・真理値の読取結果を文字列として求める
+ * @note 読取の失敗はデフォルト値の返却によってのみ判別できるため、真理値は異なる2つのデフォルト値で読み取る。
+ */
+template <class Reader>
+void ask(Reader& reader, const std::vector<Query>& queries, const bool typed, Outcome& outcome)
+{
+    for (std::size_t i = 0; i < queries.size(); ++i)
+    {
+        outcome.strings.push_back(reader.read_str(i, queries[i], missing));
+        if (!typed)
+            continue;
+        const int int_value = reader.read_int(i, queries[i], INT_MIN + 7);
+        const double double_value = reader.read_double(i, queries[i], -1.25e300);
+        const bool bool_false = reader.read_bool(i, queries[i], false);
+        const bool bool_true = reader.read_bool(i, queries[i], true);
+        std::string text = (int_value == INT_MIN + 7) ? "-" : std::to_string(int_value);
+        text += " ";
+        text += (double_value == -1.25e300) ? "-" : describe_double(double_value);
+        text += " ";
+        text += (bool_false != bool_true) ? "-" : (bool_false ? "true" : "false");
+        outcome.typed.push_back(text);
+    }
+}
+
+std::string join(const std::vector<std::pair<std::string, std::string>>& fields)
+{
+    std::string text;
+    for (const auto& field : fields)
+        text += field.first + "\x02" + field.second + "\x03";
+    return text;
+}
+
+void ask_sections(const Ini& ini, const std::vector<std::string>& sections, Outcome& outcome)
+{
+    std::vector<std::pair<std::string, std::string>> fields;
+    for (const auto& section : sections)
+    {
+        ini.read_section(section, fields);
+        outcome.sections.push_back(join(fields));
+    }
+}
+
+/// セクション名・フィールド名を指定して読み取る方式
+template <class T>
+struct NameReader
+{
+    T& target;
+
+    std::string read_str(std::size_t, const Query& q, const std::string& d) { return target.read_str(q.section, q.field, d); }
+    int read_int(std::size_t, const Query& q, const int d) { return target.read_int(q.section, q.field, d); }
+    double read_double(std::size_t, const Query& q, const double d) { return target.read_double(q.section, q.field, d); }
+    bool read_bool(std::size_t, const Query& q, const bool d) { return target.read_bool(q.section, q.field, d); }
+};
+
+/// 予め生成した読取キーで読み取る方式
+struct KeyReader
+{
+    Ini& ini;
+    std::vector<Ini::Key> keys;
+
+    KeyReader(Ini& ini, const std::vector<Query>& queries) : ini(ini)
+    {
+        for (const auto& query : queries)
+            keys.push_back(Ini::Key(query.section, query.field));
+    }
+
+    std::string read_str(std::size_t i, const Query&, const std::string& d) { return ini.read_str(keys[i], d); }
+    int read_int(std::size_t i, const Query&, const int d) { return ini.read_int(keys[i], d); }
+    double read_double(std::size_t i, const Query&, const double d) { return ini.read_double(keys[i], d); }
+    bool read_bool(std::size_t i, const Query&, const bool d) { return ini.read_bool(keys[i], d); }
+};
+
+/// 識別番号で読み取る方式
+struct SymbolReader
+{
+    Ini& ini;
+    std::vector<std::pair<Ini::Symbol, Ini::Symbol>> symbols;
+
+    SymbolReader(Ini& ini, const std::vector<Query>& queries) : ini(ini)
+    {
+        for (const auto& query : queries)
+            symbols.push_back(std::make_pair(ini.intern(query.section), ini.intern(query.field)));
+    }
+
+    std::string read_str(std::size_t i, const Query&, const std::string& d) { return ini.read_str(symbols[i].first, symbols[i].second, d); }
+    int read_int(std::size_t i, const Query&, const int d) { return ini.read_int(symbols[i].first, symbols[i].second, d); }
+    double read_double(std::size_t i, const Query&, const double d) { return ini.read_double(symbols[i].first, symbols[i].second, d); }
+    bool read_bool(std::size_t i, const Query&, const bool d) { return ini.read_bool(symbols[i].first, symbols[i].second, d); }
+};
+
+/**
+ * @struct StreamReader
+ * @brief @ref Ini::parse の通知内容から各読取の結果を求める方式
+ * @note 同一のセクション・フィールドは最初のものを採用し、値が空の場合は読取失敗とする。型変換は行わない。
+ */
+struct StreamReader : Ini::Handler
+{
+    std::map<std::pair<std::string, std::string>, std::string> values;
+    std::map<std::string, std::vector<std::pair<std::string, std::string>>> sections;
+
+    bool on_field(const Ini::StringRef& section, const Ini::StringRef& field, const Ini::StringRef& value) override
+    {
+        const std::string section_name(section.data(), section.size());
+        const std::string field_name(field.data(), field.size());
+        if (!values.emplace(std::make_pair(section_name, field_name), std::string(value.data(), value.size())).second || value.size() == 0)
+            return true;
+        sections[section_name].emplace_back(field_name, std::string(value.data(), value.size()));
+        return true;
+    }
+
+    std::string read_str(std::size_t, const Query& q, const std::string& d)
+    {
+        auto it = values.find(std::make_pair(q.section, q.field));
+        return (it == values.end() || it->second.empty()) ? d : it->second;
+    }
+    int read_int(std::size_t, const Query&, const int d) { return d; }
+    double read_double(std::size_t, const Query&, const double d) { return d; }
+    bool read_bool(std::size_t, const Query&, const bool d) { return d; }
+};
+
+/**
+ * @struct Input
+ * @brief 比較に用いる入力ファイルと問合せ
+ */
+struct Input
+{
+    std::string path;
+    std::size_t bytes;
+    std::size_t chunk_size;
+    Config config;
+    std::vector<Query> queries;
+    std::vector<std::string> sections;
+};
+
+/**
+ * @struct Engine
+ * @brief 解析方式
+ * @note run は入力を読み込み、問合せの結果を outcome へ格納する。
+ */
+struct Engine
+{
+    const char* name;
+    bool typed;
+    std::function<void(const Input&, Outcome&)> run;
+};
+
+template <class Prepare>
+Engine ini_engine(const char* name, Prepare prepare)
+{
+    return Engine{ name, true, [prepare](const Input& input, Outcome& outcome) {
+        Ini ini(input.path);
+        input.config.apply(ini);
+        prepare(ini);
+        NameReader<Ini> reader = { ini };
+        ask(reader, input.queries, true, outcome);
+        ask_sections(ini, input.sections, outcome);
+    } };
+}
+
+std::vector<Engine> engines()
+{
+    std::vector<Engine> list;
+    // 呼出し毎にファイルを走査する方式を基準とする。
+    list.push_back(ini_engine("legacy", [](Ini&) {}));
+    list.push_back(ini_engine("load", [](Ini& ini) { ini.load(); }));
+    list.push_back(ini_engine("load (mmap)", [](Ini& ini) { ini.set_memory_map(true).load(); }));
+    // 1スレッドあたり1MiBに満たない入力は分割されないため、大きな入力でのみ並列に解析する。
+    list.push_back(ini_engine("load (parallel)", [](Ini& ini) { ini.set_parallel_load(4).load(); }));
+    list.push_back(ini_engine("lazy", [](Ini& ini) { ini.set_lazy_load(true).load(); }));
+    list.push_back(ini_engine("lazy (mmap)", [](Ini& ini) { ini.set_lazy_load(true).set_memory_map(true).load(); }));
+    list.push_back(Engine{ "cache", true, [](const Input& input, Outcome& outcome) {
+        const std::string cache_path = input.path + ".cache";
+        std::remove(cache_path.c_str());
+        {
+            Ini writer(input.path);
+            input.config.apply(writer);
+            writer.set_cache_path(cache_path).load();
+        }
+        Ini ini(input.path);
+        input.config.apply(ini);
+        ini.set_cache_path(cache_path).load();
+        NameReader<Ini> reader = { ini };
+        ask(reader, input.queries, true, outcome);
+        ask_sections(ini, input.sections, outcome);
+        std::remove(cache_path.c_str());
+    } });
+    list.push_back(Engine{ "reader", true, [](const Input& input, Outcome& outcome) {
+        Ini ini(input.path);
+        input.config.apply(ini);
+        ini.load();
+        Ini::Reader view = ini.reader();
+        NameReader<Ini::Reader> reader = { view };
+        ask(reader, input.queries, true, outcome);
+        ask_sections(ini, input.sections, outcome);
+    } });
+    list.push_back(Engine{ "key", true, [](const Input& input, Outcome& outcome) {
+        Ini ini(input.path);
+        input.config.apply(ini);
+        ini.load();
+        KeyReader reader(ini, input.queries);
+        ask(reader, input.queries, true, outcome);
+        ask_sections(ini, input.sections, outcome);
+    } });
+    list.push_back(Engine{ "symbol", true, [](const Input& input, Outcome& outcome) {
+        Ini ini(input.path);
+        input.config.apply(ini);
+        ini.set_lazy_load(true).load();
+        SymbolReader reader(ini, input.queries);
+        ask(reader, input.queries, true, outcome);
+        ask_sections(ini, input.sections, outcome);
+    } });
+    list.push_back(Engine{ "stream", false, [](const Input& input, Outcome& outcome) {
+        Ini ini(input.path);
+        input.config.apply(ini);
+        StreamReader reader;
+        ini.parse(reader, input.chunk_size);
+        ask(reader, input.queries, false, outcome);
+        for (const auto& section : input.sections)
+        {
+            auto it = reader.sections.find(section);
+            outcome.sections.push_back(it == reader.sections.end() ? std::string() : join(it->second));
+        }
+    } });
+#if defined(INI_WITH_ZLIB)
+    list.push_back(Engine{ "gzip", true, [](const Input& input, Outcome& outcome) {
+        const std::string gzip_path = input.path + ".gz";
+        std::ifstream ifs(input.path, std::ios::binary);
+        const std::string text((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        gzFile file = gzopen(gzip_path.c_str(), "wb");
+        gzwrite(file, text.data(), static_cast<unsigned int>(text.size()));
+        gzclose(file);
+        Ini ini(gzip_path);
+        input.config.apply(ini);
+        ini.load();
+        NameReader<Ini> reader = { ini };
+        ask(reader, input.queries, true, outcome);
+        ask_sections(ini, input.sections, outcome);
+        std::remove(gzip_path.c_str());
+    } });
+#endif
+    return list;
+}
+
+/**
+ * @class Generator
+ * @brief 解析規則の境界となる行を含むiniファイルのランダムな生成
+ * @note 名前は少数の候補から選び、同一のセクション・フィールドが繰り返し現れるようにする。
+ */
+class Generator
+{
+public:
+    explicit Generator(const unsigned int seed) : rng_(seed) {}
+
+    Config config()
+    {
+        static const char separators[] = { '=', '=', '=', ':', ' ' };
+        static const char* const prefixes[] = { "#", ";", "//", "--" };
+        Config config;
+        config.separator = separators[pick(sizeof(separators))];
+        for (const char* prefix : prefixes)
+        {
+            if (chance(50))
+                config.prefixes.push_back(prefix);
+        }
+        return config;
+    }
+
+    std::string text(const Config& config, const std::size_t lines, const bool malformed_lines = true)
+    {
+        std::string text;
+        const char* newline = chance(20) ? "\r\n" : "\n";
+        // セクションより前のフィールドは不正な行となる。
+        if (!malformed_lines)
+            text += header(false) + newline;
+        else if (chance(3))
+            text += field(config) + newline;
+        for (std::size_t i = 0; i < lines; ++i)
+        {
+            const unsigned int kind = pick(100);
+            if (kind < 12)
+                text += header(malformed_lines);
+            else if (kind < 80)
+                text += field(config);
+            else if (kind < 88)
+                text += comment(config);
+            else if (kind < 99 || !malformed_lines)
+                text += blank();
+            else
+                text += malformed();
+            if (i + 1 < lines || chance(80))
+                text += newline;
+        }
+        return text;
+    }
+
+    std::vector<Query> queries()
+    {
+        std::vector<Query> queries;
+        for (const char* section : section_names)
+        {
+            for (const char* field : field_names)
+                queries.push_back(Query{ section, field });
+        }
+        queries.push_back(Query{ "missing", "k" });
+        queries.push_back(Query{ "a", "missing" });
+        queries.push_back(Query{ "A", "k" });
+        return queries;
+    }
+
+    std::vector<std::string> sections()
+    {
+        std::vector<std::string> sections(std::begin(section_names), std::end(section_names));
+        sections.push_back("missing");
+        return sections;
+    }
+
+    std::string malformed()
+    {
+        static const char* const lines[] = { "no separator", "[unclosed", "[]", "]" };
+        return lines[pick(4)];
+    }
+
+    unsigned int pick(const std::size_t count) { return static_cast<unsigned int>(rng_() % count); }
+    bool chance(const unsigned int percent) { return pick(100) < percent; }
+
+private:
+    static const char* const section_names[6];
+    static const char* const field_names[6];
+
+    std::mt19937 rng_;
+
+    std::string padding()
+    {
+        static const char* const paddings[] = { "", "", "", " ", "  ", "\t", " \t " };
+        return paddings[pick(sizeof(paddings) / sizeof(paddings[0]))];
+    }
+
+    std::string header(const bool trailing)
+    {
+        std::string line = padding() + "[" + section_names[pick(6)] + "]";
+        if (trailing && chance(10))
+            line += chance(50) ? " ; trailing" : "x=1";
+        return line + padding();
+    }
+
+    std::string value(const Config& config)
+    {
+        switch (pick(12))
+        {
+        case 0: return std::to_string(static_cast<int>(rng_()));
+        case 1: return std::to_string(pick(1000));
+        case 2: return "-" + std::to_string(pick(100));
+        case 3: return chance(50) ? "99999999999" : "-2147483648";
+        case 4: return std::to_string(pick(1000)) + "." + std::to_string(pick(1000));
+        case 5: { static const char* const v[] = { "1e3", "-0.0", ".5", "5.", "1e400", "0x10", "nan", " 12 " }; return v[pick(8)]; }
+        case 6: { static const char* const v[] = { "true", "FALSE", "True", "1", "0", "yes", "TRUE " }; return v[pick(7)]; }
+        case 7: return "";
+        case 8: return std::string("a") + config.separator + "b";
+        case 9: return "12abc";
+        case 10: return "value with spaces";
+        default: return "v" + std::to_string(pick(50));
+        }
+    }
+
+    std::string field(const Config& config)
+    {
+        return padding() + field_names[pick(6)] + padding() + config.separator + padding() + value(config) + padding();
+    }
+
+    std::string comment(const Config& config)
+    {
+        const std::string prefix = (!config.prefixes.empty() && chance(80)) ? config.prefixes[pick(config.prefixes.size())] : "#";
+        return padding() + prefix + (chance(50) ? " comment" : "k=v");
+    }
+
+    std::string blank()
+    {
+        return padding();
+    }
+};
+
+const char* const Generator::section_names[6] = { "a", "b", "Sec", "x y", "a.b", " a" };
+const char* const Generator::field_names[6] = { "k", "key", "v1", "name", "k k", "x" };
+
+void write_text(const std::string& path, const std::string& text)
+{
+    std::ofstream ofs(path, std::ios::binary);
+    ofs.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+/**
+ * @fn throughput_text
+ * @brief スループットの計測に用いる固定の入力を生成し、問合せを input へ格納する
+ * @note 並列解析が分割して解析するよう2MiBを超える大きさとする。
+ */
+std::string throughput_text(Input& input)
+{
+    std::mt19937 rng(12345);
+    std::string text;
+    for (int section = 0; section < 10000; ++section)
+    {
+        const std::string name = "section_" + std::to_string(section);
+        text += "[" + name + "]\n";
+        if (section % 16 == 0)
+            text += "; comment\n";
+        for (int field = 0; field < 16; ++field)
+        {
+            text += "field_" + std::to_string(field) + " = ";
+            switch (field % 4)
+            {
+            case 0: text += std::to_string(static_cast<int>(rng() % 100000)); break;
+            case 1: text += std::to_string(rng() % 1000) + ".25"; break;
+            case 2: text += (rng() % 2 == 0) ? "true" : "false"; break;
+            default: text += "value_" + std::to_string(rng() % 1000); break;
+            }
+            text += "\n";
+        }
+        if (section % 625 == 0)
+        {
+            input.queries.push_back(Query{ name, "field_" + std::to_string(section % 16) });
+            input.sections.push_back(name);
+        }
+    }
+    return text;
+}
+
+/**
+ * @fn compare
+ * @brief 全ての方式で入力を読み込み、基準とする方式と結果を比較する
+ * @return bool 全ての方式の結果が一致した場合はtrueを返却する。
+ */
+bool compare(const std::vector<Engine>& list, const Input& input, std::size_t& failures)
+{
+    Outcome expected;
+    list[0].run(input, expected);
+
+    bool matched = true;
+    for (std::size_t e = 1; e < list.size(); ++e)
+    {
+        Outcome actual;
+        list[e].run(input, actual);
+        for (std::size_t i = 0; i < input.queries.size(); ++i)
+        {
+            const bool same = actual.strings[i] == expected.strings[i] && (!list[e].typed || actual.typed[i] == expected.typed[i]);
+            if (same)
+                continue;
+            std::printf("mismatch: %s vs %s (%s) [%s] %s\n", list[e].name, list[0].name, input.config.describe().c_str(),
+                        input.queries[i].section.c_str(), input.queries[i].field.c_str());
+            std::printf("  expected \"%s\" %s\n  actual   \"%s\" %s\n", expected.strings[i].c_str(), expected.typed[i].c_str(),
+                        actual.strings[i].c_str(), list[e].typed ? actual.typed[i].c_str() : "");
+            matched = false;
+            break;
+        }
+        for (std::size_t i = 0; i < input.sections.size(); ++i)
+        {
+            if (actual.sections[i] == expected.sections[i])
+                continue;
+            std::printf("mismatch: %s vs %s (%s) read_section [%s]\n", list[e].name, list[0].name, input.config.describe().c_str(),
+                        input.sections[i].c_str());
+            matched = false;
+            break;
+        }
+    }
+
+    if (!matched)
+    {
+        const std::string saved = "ini_fuzz_failure_" + std::to_string(failures++) + ".ini";
+        std::ifstream ifs(input.path, std::ios::binary);
+        write_text(saved, std::string((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>()));
+        std::printf("  input saved to %s\n", saved.c_str());
+    }
+    return matched;
+}
+
+/**
+ * @fn check_write_behind
+ * @brief 遅延書込の内容が失われないことを検査する
+ * @return std::size_t ファイルへ正しく書き込まれなかった試行の回数
+ * @note 最初の遅延書込の直後にインスタンスを破棄する場合と、他スレッドの書込中に遅延書込を解除する場合を検査する。
+ */
+std::size_t check_write_behind()
+{
+    const std::string path = "ini_fuzz_write_behind.ini";
+    std::size_t lost = 0;
+    for (int i = 0; i < 50; ++i)
+    {
+        write_text(path, "[s]\nk=1\n");
+        {
+            Ini ini(path);
+            ini.set_write_behind(std::chrono::seconds(60)).load();
+            ini.write_int("s", "k", 2);
+        }
+        if (Ini(path).read_int("s", "k", 0) != 2)
+            ++lost;
+    }
+    for (int i = 0; i < 20; ++i)
+    {
+        write_text(path, "[s]\nk=0\n");
+        {
+            Ini ini(path);
+            ini.set_write_behind(std::chrono::seconds(60)).load();
+            std::thread writer([&ini]
+            {
+                for (int value = 1; value <= 200; ++value)
+                    ini.write_int("s", "k", value);
+            });
+            ini.set_write_behind(std::chrono::milliseconds(0));
+            writer.join();
+        }
+        if (Ini(path).read_int("s", "k", 0) != 200)
+            ++lost;
+    }
+    std::remove(path.c_str());
+    return lost;
+}
+
+/**
+ * @fn measure
+ * @brief 最小計測時間に達するまで方式の読込と問合せを繰り返し、入力1バイトあたりのスループット(MB/s)を求める
+ */
+double measure(const Engine& engine, const Input& input, const double min_time)
+{
+    typedef std::chrono::steady_clock Clock;
+    unsigned long long iterations = 0;
+    double seconds = 0.0;
+    const Clock::time_point start = Clock::now();
+    while (seconds < min_time)
+    {
+        Outcome outcome;
+        engine.run(input, outcome);
+        ++iterations;
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+    return iterations * input.bytes / seconds / (1024.0 * 1024.0);
+}
+
+std::map<std::string, double> read_baseline(const std::string& path)
+{
+    std::map<std::string, double> baseline;
+    std::ifstream ifs(path);
+    std::string line;
+    while (std::getline(ifs, line))
+    {
+        const std::size_t tab = line.rfind('\t');
+        if (line.empty() || line[0] == '#' || tab == std::string::npos)
+            continue;
+        baseline[line.substr(0, tab)] = std::atof(line.c_str() + tab + 1);
+    }
+    return baseline;
+}
+
+struct Options
+{
+    std::size_t iterations;
+    unsigned int seed;
+    std::vector<std::string> corpus;
+    std::string save_baseline;
+    std::string baseline;
+    double tolerance;
+    double min_time;
+};
+
+const char* scanner_name()
+{
+#if defined(INI_SIMD_AVX2)
+    return "avx2";
+#elif defined(INI_SIMD_SSE2)
+    return "sse2";
+#elif defined(INI_SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+int run(const Options& options)
+{
+    const std::vector<Engine> list = engines();
+    Generator generator(options.seed);
+    std::size_t failures = 0;
+    std::size_t inputs = 0;
+
+    // 差分検査
+    Input input;
+    input.path = "ini_fuzz_input.ini";
+    // 行が読込単位の境界を跨ぐよう、差分検査では小さな読込単位で逐次解析する。
+    input.chunk_size = 7;
+    for (std::size_t i = 0; i < options.iterations && failures < 10; ++i)
+    {
+        input.config = generator.config();
+        input.queries = generator.queries();
+        input.sections = generator.sections();
+        // 並列解析は1スレッドあたり1MiB以上の入力でのみ分割するため、一定間隔で大きな入力を生成する。
+        // 不正な行以降は読み込まれないため、大きな入力では不正な行を後半に高々1つだけ含める。
+        const bool large = (i % 200 == 0);
+        std::string text;
+        if (large)
+        {
+            text = generator.text(input.config, 160000, false);
+            if (generator.chance(50))
+                text += "\n" + generator.malformed() + "\n" + generator.text(input.config, 40000, false);
+            input.queries.resize(8);
+        }
+        else
+        {
+            text = generator.text(input.config, 1 + generator.pick(60));
+        }
+        write_text(input.path, text);
+        input.bytes = text.size();
+        compare(list, input, failures);
+        ++inputs;
+    }
+    for (const auto& path : options.corpus)
+    {
+        Input corpus;
+        corpus.path = path;
+        corpus.chunk_size = 7;
+        corpus.queries = generator.queries();
+        corpus.sections = generator.sections();
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs.is_open())
+        {
+            std::printf("cannot open %s\n", path.c_str());
+            return 1;
+        }
+        // コーパスは実在するセクション・フィールドも問い合わせる。
+        struct Collector : Ini::Handler
+        {
+            Input& input;
+            explicit Collector(Input& input) : input(input) {}
+            bool on_field(const Ini::StringRef& section, const Ini::StringRef& field, const Ini::StringRef&) override
+            {
+                if (input.queries.size() < 256)
+                    input.queries.push_back(Query{ std::string(section.data(), section.size()), std::string(field.data(), field.size()) });
+                return true;
+            }
+            bool on_section(const Ini::StringRef& section) override
+            {
+                if (input.sections.size() < 64)
+                    input.sections.push_back(std::string(section.data(), section.size()));
+                return true;
+            }
+        };
+        Collector collector(corpus);
+        Ini(path).parse(collector);
+        for (const Config& config : { Config{ '=', { "#", ";" } }, Config{ ':', { "#", ";" } }, Config{ '=', {} } })
+        {
+            corpus.config = config;
+            corpus.bytes = 0;
+            compare(list, corpus, failures);
+            ++inputs;
+        }
+    }
+    std::printf("differential: %zu inputs, %zu engines, scanner %s, %zu failures\n", inputs, list.size(), scanner_name(), failures);
+
+    // 遅延書込
+    const std::size_t lost = check_write_behind();
+    std::printf("write-behind: %zu lost writes\n", lost);
+
+    // スループット
+    Input bench;
+    bench.path = "ini_fuzz_throughput.ini";
+    bench.chunk_size = 64 * 1024;
+    bench.config = Config{ '=', { "#", ";" } };
+    const std::string text = throughput_text(bench);
+    write_text(bench.path, text);
+    bench.bytes = text.size();
+
+    const std::map<std::string, double> baseline = options.baseline.empty() ? std::map<std::string, double>() : read_baseline(options.baseline);
+    std::FILE* save = options.save_baseline.empty() ? nullptr : std::fopen(options.save_baseline.c_str(), "w");
+    if (save != nullptr)
+        std::fprintf(save, "# ini_fuzz throughput baseline (MB/s, scanner %s)\n", scanner_name());
+    bool regressed = false;
+    std::printf("%-18s %12s %12s %8s\n", "engine", "MB/s", "baseline", "ratio");
+    for (const auto& engine : list)
+    {
+        const double throughput = measure(engine, bench, options.min_time);
+        if (save != nullptr)
+            std::fprintf(save, "%s\t%.2f\n", engine.name, throughput);
+        auto it = baseline.find(engine.name);
+        if (it == baseline.end() || it->second <= 0.0)
+        {
+            std::printf("%-18s %12.2f %12s %8s\n", engine.name, throughput, "-", "-");
+            continue;
+        }
+        const double ratio = throughput / it->second;
+        const bool slow = ratio < 1.0 - options.tolerance;
+        regressed = regressed || slow;
+        std::printf("%-18s %12.2f %12.2f %8.2f%s\n", engine.name, throughput, it->second, ratio, slow ? "  REGRESSED" : "");
+    }
+    if (save != nullptr)
+        std::fclose(save);
+
+    std::remove(input.path.c_str());
+    std::remove(bench.path.c_str());
+    return (failures != 0 || lost != 0 || regressed) ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    options.iterations = 1000;
+    options.seed = 1;
+    options.tolerance = 0.25;
+    options.min_time = 0.3;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc)
+            options.iterations = static_cast<std::size_t>(std::strtoull(argv[++i], nullptr, 10));
+        else if (arg == "--seed" && i + 1 < argc)
+            options.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--corpus" && i + 1 < argc)
+            options.corpus.push_back(argv[++i]);
+        else if (arg == "--save-baseline" && i + 1 < argc)
+            options.save_baseline = argv[++i];
+        else if (arg == "--baseline" && i + 1 < argc)
+            options.baseline = argv[++i];
+        else if (arg == "--tolerance" && i + 1 < argc)
+            options.tolerance = std::atof(argv[++i]);
+        else if (arg == "--min-time" && i + 1 < argc)
+            options.min_time = std::atof(argv[++i]);
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--iterations N] [--seed N] [--corpus FILE]... [--save-baseline FILE] [--baseline FILE]"
+                                 " [--tolerance RATIO] [--min-time SECONDS]\n", argv[0]);
+            return 1;
+        }
+    }
+    return run(options);
+}
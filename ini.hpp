@@ -18,12 +18,338 @@
 #include <vector>
 #include <algorithm>
 #include <fstream>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+#include <functional>
+#include <future>
+#include <deque>
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define INI_HAS_CXX17 1
+#include <string_view>
+#include <optional>
+#else
+#define INI_HAS_CXX17 0
+#endif
+
+#if INI_HAS_CXX17 && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#define INI_HAS_CHARCONV 1
+#endif
+#endif
+#ifndef INI_HAS_CHARCONV
+#define INI_HAS_CHARCONV 0
+#endif
+
+#if INI_HAS_CXX17 && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define INI_HAS_MEMORY_RESOURCE 1
+#endif
+#endif
+#ifndef INI_HAS_MEMORY_RESOURCE
+#define INI_HAS_MEMORY_RESOURCE 0
+#endif
+
+// 浮動小数点数の std::from_chars / std::to_chars は標準ライブラリにより提供状況が異なるため別途判定する。
+#if INI_HAS_CHARCONV && defined(__cpp_lib_to_chars)
+#define INI_HAS_CHARCONV_FLOAT 1
+#else
+#define INI_HAS_CHARCONV_FLOAT 0
+#endif
+
+// INI_DISABLE_SIMD を定義した場合はベクトル命令を使用せず、スカラ実装で走査する。
+#if !defined(INI_DISABLE_SIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#define INI_SIMD_AVX2 1
+#elif !defined(INI_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define INI_SIMD_SSE2 1
+#elif !defined(INI_DISABLE_SIMD) && (defined(__aarch64__) || defined(_M_ARM64))
+#include <arm_neon.h>
+#define INI_SIMD_NEON 1
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// INI_ENABLE_INSTRUMENTATION を定義した場合は Ini::set_instrumentation で指定した通知先へ計測値を通知する。
+// 定義しない場合は計測処理を含まない(同一プログラム内の全ての翻訳単位で定義の有無を揃えること)。
+
+// INI_WITH_ZLIB を定義した場合はgzip形式のiniファイルを展開しながら読み込み、拡張子が".gz"のファイルへは圧縮して書き込む。
+// zlibのリンク(-lz)が必要となる。
+#if defined(INI_WITH_ZLIB)
+#include <zlib.h>
+#endif
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 class Ini final
 {
 
 public:
 
+    /**
+     * @class StringRef
+     * @brief セクション名・フィールド名を複製せずに参照する文字列参照クラス
+     * @note std::string および const char* から暗黙に変換されるため、呼出し側で一時的な std::string を生成する必要はない。
+     *       参照先の文字列は呼出し中のみ有効であればよい。
+     */
+    class StringRef
+    {
+    public:
+        StringRef(const std::string& str) : data_(str.data()), size_(str.size()) {}
+        StringRef(const char* str) : data_(str), size_(std::strlen(str)) {}
+        StringRef(const char* data, const std::size_t size) : data_(data), size_(size) {}
+#if INI_HAS_CXX17
+        StringRef(std::string_view str) : data_(str.data()), size_(str.size()) {}
+#endif
+
+        const char* data() const { return data_; }
+        std::size_t size() const { return size_; }
+
+        bool equals(const char* data, const std::size_t size) const
+        {
+            return size_ == size && std::memcmp(data_, data, size) == 0;
+        }
+
+        bool equals(const std::string& str) const
+        {
+            return equals(str.data(), str.size());
+        }
+
+    private:
+        const char* data_;
+        std::size_t size_;
+    };
+
+    /**
+     * @class Key
+     * @brief セクション名・フィールド名の組を予め解決しておくための読取キー
+     * @note 初回の読取時に保持しているドキュメント上のフィールド位置を記録し、以降の読取ではハッシュ値の算出や
+     *       文字列比較を行わずにその位置を参照する。再読込・書込によりドキュメントが差し替わった場合は
+     *       次の読取時に一度だけ位置を解決し直す。読取時に内部状態を更新するため、1つのインスタンスを
+     *       複数スレッドで同時に使用しないこと。
+     */
+    class Key
+    {
+    public:
+
+        /**
+         * @fn Key
+         * @brief コンストラクタ
+         * @param std::string section_name []で囲まれたセクション名
+         * @param std::string field_name 取得したいフィールド名
+         */
+        Key(const std::string& section_name, const std::string& field_name)
+         :  section_(section_name), field_(field_name), hash_(hash_key(section_, field_)), serial_(0), index_(0)
+        {}
+
+        const std::string& section() const { return section_; }
+        const std::string& field() const { return field_; }
+
+    private:
+        friend class Ini;
+
+        std::string section_;
+        std::string field_;
+        std::uint64_t hash_;
+        std::uint64_t serial_;    ///< 位置を解決したドキュメントの通し番号 (0は未解決)
+        std::size_t index_;       ///< 解決したエントリの位置+1 (0は該当なし)
+    };
+
+    /**
+     * @class Symbol
+     * @brief @ref intern によりセクション名・フィールド名へ割り当てた識別番号
+     * @note 同一の名前には同一のパーサインスタンス(およびそのコピー)の間で常に同じ番号を割り当て、
+     *       再読込・書込によっても変わらない。番号は1から順に割り当てるため、呼出し側で配列の添字や
+     *       連想配列のキーとして用いることができる。0は無効な識別番号を表す。
+     */
+    class Symbol
+    {
+    public:
+        Symbol() : id_(0) {}
+        explicit Symbol(const std::uint32_t id) : id_(id) {}
+
+        std::uint32_t id() const { return id_; }
+        bool valid() const { return id_ != 0; }
+
+        bool operator==(const Symbol& other) const { return id_ == other.id_; }
+        bool operator!=(const Symbol& other) const { return id_ != other.id_; }
+        bool operator<(const Symbol& other) const { return id_ < other.id_; }
+
+    private:
+        std::uint32_t id_;
+    };
+
+    /**
+     * @class Instrumentation
+     * @brief 計測値の通知先クラス
+     * @note INI_ENABLE_INSTRUMENTATION を定義した場合のみ @ref set_instrumentation で指定でき、定義しない場合は
+     *       各計測箇所を含まずにコンパイルする。通知は計測箇所を実行したスレッドから行うため、
+     *       複数スレッドから読み書きする場合は各メソッドをスレッドセーフに実装すること。
+     */
+    class Instrumentation
+    {
+    public:
+        /**
+         * @enum Counter
+         * @brief 計数の種別
+         */
+        enum Counter
+        {
+            FILE_OPENS,             ///< ファイルを開いた回数
+            BYTES_READ,             ///< ファイルから読み込んだバイト数
+            LINES_SCANNED,          ///< 解析・走査した行数
+            LOOKUPS,                ///< フィールド値の検索回数
+            HITS,                   ///< フィールド値が存在した回数
+            MISSES,                 ///< フィールドが存在しない、もしくは値が空であった回数
+            CONVERSION_FAILURES,    ///< フィールド値を指定の型へ変換できなかった回数
+            WRITES,                 ///< ファイルへの書込回数
+            COUNTER_COUNT
+        };
+
+        /**
+         * @enum Timer
+         * @brief 処理時間の計測対象
+         */
+        enum Timer
+        {
+            PARSE,                  ///< ファイル内容の解析
+            COMMIT,                 ///< write系メソッドおよび @ref Transaction::commit によるファイルの書込
+            TIMER_COUNT
+        };
+
+        virtual ~Instrumentation() {}
+
+        /**
+         * @fn on_count
+         * @brief 計数の通知メソッド
+         * @param Counter counter 計数の種別
+         * @param std::uint64_t amount 加算する値
+         */
+        virtual void on_count(const Counter counter, const std::uint64_t amount) = 0;
+
+        /**
+         * @fn on_latency
+         * @brief 処理時間の通知メソッド
+         * @param Timer timer 計測対象
+         * @param std::chrono::nanoseconds elapsed 処理時間
+         */
+        virtual void on_latency(const Timer timer, const std::chrono::nanoseconds elapsed) = 0;
+    };
+
+    /**
+     * @class Statistics
+     * @brief 計数と処理時間の分布を保持する @ref Instrumentation の標準実装
+     * @note 処理時間はナノ秒単位の2の冪毎の区間(区間iは[2^i, 2^(i+1))ナノ秒)で度数を集計する。
+     *       各値はスレッド間で不可分に更新するが、複数の値を同時点のものとして取得することはできない。
+     */
+    class Statistics : public Instrumentation
+    {
+    public:
+        static const std::size_t bucket_count = 64;
+
+        Statistics()
+        {
+            reset();
+        }
+
+        void on_count(const Counter counter, const std::uint64_t amount) override
+        {
+            counters_[counter].fetch_add(amount, std::memory_order_relaxed);
+        }
+
+        void on_latency(const Timer timer, const std::chrono::nanoseconds elapsed) override
+        {
+            std::uint64_t nanoseconds = elapsed.count() > 0 ? static_cast<std::uint64_t>(elapsed.count()) : 0;
+            totals_[timer].fetch_add(nanoseconds, std::memory_order_relaxed);
+            std::size_t bucket = 0;
+            while (nanoseconds >>= 1)
+                ++bucket;
+            histograms_[timer][bucket].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * @fn count
+         * @brief 計数の取得メソッド
+         * @param Counter counter 計数の種別
+         * @return std::uint64_t 生成もしくは @ref reset 以降の累計
+         */
+        std::uint64_t count(const Counter counter) const
+        {
+            return counters_[counter].load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @fn latency_count
+         * @brief 処理時間の度数の取得メソッド
+         * @param Timer timer 計測対象
+         * @param std::size_t bucket 区間の番号(bucket_count 未満)
+         * @return std::uint64_t 処理時間が[2^bucket, 2^(bucket+1))ナノ秒であった回数
+         */
+        std::uint64_t latency_count(const Timer timer, const std::size_t bucket) const
+        {
+            return histograms_[timer][bucket].load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @fn latency_total
+         * @brief 処理時間の累計の取得メソッド
+         * @param Timer timer 計測対象
+         * @return std::chrono::nanoseconds 処理時間の累計
+         */
+        std::chrono::nanoseconds latency_total(const Timer timer) const
+        {
+            return std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(totals_[timer].load(std::memory_order_relaxed)));
+        }
+
+        /**
+         * @fn reset
+         * @brief 全ての計数と度数を0に戻すメソッド
+         */
+        void reset()
+        {
+            for (std::size_t i = 0; i < COUNTER_COUNT; ++i)
+                counters_[i].store(0, std::memory_order_relaxed);
+            for (std::size_t i = 0; i < TIMER_COUNT; ++i)
+            {
+                totals_[i].store(0, std::memory_order_relaxed);
+                for (std::size_t j = 0; j < bucket_count; ++j)
+                    histograms_[i][j].store(0, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        std::atomic<std::uint64_t> counters_[COUNTER_COUNT];
+        std::atomic<std::uint64_t> totals_[TIMER_COUNT];
+        std::atomic<std::uint64_t> histograms_[TIMER_COUNT][bucket_count];
+    };
+
     /**
      * @fn Ini
      * @brief コンストラクタ
@@ -31,7 +357,11 @@ public:
      * @param std::string file_path iniファイルへのパス 
      */
     Ini(const std::string &file_path)
-     :  file_path_(std::string(file_path.c_str())), field_separator_('='), comment_prefix_list_({"#", ";"})
+     :  file_path_(std::string(file_path.c_str())), field_separator_('='), comment_prefix_list_({"#", ";"}), memory_map_(false), parallel_load_(1), in_place_write_(false), lazy_load_(false), cache_path_(), memory_resource_(nullptr)
+#if defined(INI_ENABLE_INSTRUMENTATION)
+        , instrumentation_(nullptr)
+#endif
+        , write_behind_interval_(0), write_behind_limit_(0), dirty_count_(0), symbols_(std::make_shared<SymbolTable>())
     {}
 
     /**
@@ -40,373 +370,5810 @@ public:
      * @param char field_separator 区切り文字
      * @return Ini& 区切り文字変更後のパーサインスタンス
      * @note インスタンス生成時のデフォルト区切り文字は'='としている。
+     *       @ref attach で参照中の場合は参照し直し、公開側の解析規則と一致しない場合は参照中のドキュメントを破棄する。
      */
     Ini& set_field_separator(const char field_separator)
     {
-        field_separator_ = field_separator;
+        reparse_document([this, field_separator] { field_separator_ = field_separator; });
+        return *this;
+    }
+
+    /**
+     * @fn set_comment_prefix_list
+     * @brief コメント行の先頭文字列指定メソッド
+     * @param std::vector<std::string> コメント行の先頭文字列(複数指定可能)
+     * @return Ini& コメント行の先頭文字列変更後のパーサインスタンス
+     * @note インスタンス生成時のデフォルトコメント行の先頭文字列は{ "#", ";" }としている。
+     *       @ref attach で参照中の場合は参照し直し、公開側の解析規則と一致しない場合は参照中のドキュメントを破棄する。
+     */
+    Ini& set_comment_prefix_list(const std::vector<std::string>& comment_prefix_list)
+    {
+        reparse_document([this, &comment_prefix_list] { comment_prefix_list_ = comment_prefix_list; });
+        return *this;
+    }
+
+    /**
+     * @fn set_memory_map
+     * @brief @ref load 時にファイルをメモリマップして読み込むかどうかの指定メソッド
+     * @param bool memory_map trueの場合はファイル内容を複製せず、マップした領域を直接解析・参照する。
+     * @return Ini& 指定変更後のパーサインスタンス
+     * @note インスタンス生成時のデフォルトはfalse(ファイル内容をメモリ上に複製する)としている。
+     */
+    Ini& set_memory_map(const bool memory_map)
+    {
+        memory_map_ = memory_map;
+        return *this;
+    }
+
+    /**
+     * @fn set_parallel_load
+     * @brief ファイル内容の解析に用いるスレッド数の指定メソッド
+     * @param unsigned int thread_count 解析に用いるスレッド数(0の場合は実行環境のハードウェアスレッド数)
+     * @return Ini& 指定変更後のパーサインスタンス
+     * @note インスタンス生成時のデフォルトは1(呼出し元スレッドのみで解析する)としている。
+     *       ファイル内容を行単位で分割して並列に解析するため、1スレッドあたり1MiBに満たない部分は分割しない。
+     */
+    Ini& set_parallel_load(const unsigned int thread_count)
+    {
+        parallel_load_ = thread_count;
+        return *this;
+    }
+
+    /**
+     * @fn set_in_place_write
+     * @brief write系メソッドで既存フィールドの値の範囲のみをファイル上で直接書き換えるかどうかの指定メソッド
+     * @param bool in_place_write trueの場合は書込対象の値の範囲(値の長さが変わる場合はその位置以降)のみを書き込み、
+     *        それ以外の行はインデント・コメントを含めてそのまま残す。
+     * @return Ini& 指定変更後のパーサインスタンス
+     * @note インスタンス生成時のデフォルトはfalse(一時ファイルへ全体を書き込んで置き換える)としている。
+     *       直接書き換えるため、書込途中で異常終了した場合や他プロセスが同時に読み込んだ場合は書換途中の内容となり得る。
+     *       書込対象に存在しないセクション・フィールドを含む場合、およびメモリマップしたドキュメントを保持している場合は
+     *       従来どおり全体を書き込む。同一のセクション・フィールドが複数回現れる場合は全体を書き込む場合と同様に
+     *       全ての値を書き換える。
+     */
+    Ini& set_in_place_write(const bool in_place_write)
+    {
+        in_place_write_ = in_place_write;
+        return *this;
+    }
+
+    /**
+     * @fn set_lazy_load
+     * @brief @ref load 時にセクション単位で遅延して解析するかどうかの指定メソッド
+     * @param bool lazy_load trueの場合は読込時にセクション行の位置のみを記録し、各セクション行のフィールドは
+     *        そのセクションのフィールドを最初に検索した時点で解析する。
+     * @return Ini& 指定変更後のパーサインスタンス
+     * @note インスタンス生成時のデフォルトはfalse(読込時に全てのフィールドを解析する)としている。
+     *       @ref set_memory_map と併用した場合、参照しないセクションの内容はメモリへ読み込まれない。
+     *       セクション単位の一括取得・識別番号による読取・書込等の全体を参照する処理は、初回の呼出し時に全体を解析する。
+     *       @ref set_cache_path を指定した場合はキャッシュファイルを優先する。
+     */
+    Ini& set_lazy_load(const bool lazy_load)
+    {
+        lazy_load_ = lazy_load;
+        return *this;
+    }
+
+    /**
+     * @fn set_cache_path
+     * @brief @ref load で用いる解析済みキャッシュファイルのパスの指定メソッド
+     * @param std::string cache_path キャッシュファイルへのパス(空の場合はキャッシュを使用しない)
+     * @return Ini& 指定変更後のパーサインスタンス
+     * @note キャッシュファイルにはフィールドの位置情報・索引・変換済みの数値を格納する。@ref load 時にiniファイルの
+     *       更新日時・サイズおよび区切り文字・コメント行の先頭文字列が作成時と一致する場合はキャッシュファイルを
+     *       メモリマップし、解析を行わずに値を返却する。一致しない場合はiniファイルを解析してキャッシュファイルを作り直す。
+     */
+    Ini& set_cache_path(const std::string& cache_path)
+    {
+        cache_path_ = cache_path;
+        return *this;
+    }
+
+    /**
+     * @fn set_write_behind
+     * @brief write系メソッドの書込内容をメモリ上にのみ反映し、バックグラウンドでまとめてファイルへ書き込む遅延書込の指定メソッド
+     * @param std::chrono::milliseconds interval ファイルへ書き込む周期(0の場合は遅延書込を行わない)
+     * @param std::size_t dirty_limit 前回の書込以降の書込件数がこの値に達した場合は周期を待たずに書き込む(0の場合は周期のみ)
+     * @return Ini& 指定変更後のパーサインスタンス
+     * @note インスタンス生成時のデフォルトは0(write系メソッドの呼出し毎にファイルへ書き込む)としている。
+     *       遅延書込中のwrite系メソッドは保持しているドキュメント(保持していない場合は読み込んだ上で)を更新して返却し、
+     *       以降のread系メソッドは書き込んだ値を返却する。同一のセクション・フィールドへの書込は最後の値のみを書き込む。
+     *       終了時は @ref flush を呼び出すこと。遅延書込中は @ref set_cache_path で指定したキャッシュファイルを用いない。
+     */
+    Ini& set_write_behind(const std::chrono::milliseconds& interval, const std::size_t dirty_limit = 0)
+    {
+        {
+            // 未反映の書込の書出しと方式の切替を同一のロック内で行い、切替中の書込が旧方式で蓄積されないようにする。
+            std::lock_guard<Mutex> lock(write_mutex_);
+            if (interval.count() == 0)
+                flush_dirty();
+            write_behind_interval_ = interval;
+            write_behind_limit_ = dirty_limit;
+        }
+        // スレッドは書込時にロックを取得するため、ロックの解放後に停止する。
+        if (interval.count() == 0)
+            flusher_.stop();
+        return *this;
+    }
+
+#if INI_HAS_MEMORY_RESOURCE
+    /**
+     * @fn set_memory_resource
+     * @brief ドキュメントの領域確保に用いるメモリリソースの指定メソッド
+     * @param std::pmr::memory_resource* memory_resource 領域確保に用いるメモリリソース(nullptrの場合は既定のoperator new)
+     * @return Ini& 指定変更後のパーサインスタンス
+     * @note 次回の @ref load 以降に生成するドキュメントに適用する。メモリリソースは、それを用いて生成した
+     *       ドキュメントが全て破棄されるまで有効であること。
+     */
+    Ini& set_memory_resource(std::pmr::memory_resource* memory_resource)
+    {
+        memory_resource_ = memory_resource;
+        return *this;
+    }
+#endif
+
+#if defined(INI_ENABLE_INSTRUMENTATION)
+    /**
+     * @fn set_instrumentation
+     * @brief 計測値の通知先の指定メソッド
+     * @param Instrumentation* instrumentation 通知先(nullptrの場合は通知しない)
+     * @return Ini& 指定変更後のパーサインスタンス
+     * @note 通知先は本インスタンスの使用を終えるまで有効であること。他スレッドがread・write系メソッドを
+     *       呼び出している間に変更しないこと。@ref set_lazy_load を指定した場合は各セクションの解析時にも通知するため、
+     *       読み込んだドキュメントを参照する @ref Reader の使用を終えるまで有効であること。
+     */
+    Ini& set_instrumentation(Instrumentation* instrumentation)
+    {
+        instrumentation_ = instrumentation;
         return *this;
     }
+#endif
+
+    /**
+     * @fn load
+     * @brief iniファイルを一度だけ読み込み、メモリ上のドキュメントとして保持するメソッド
+     * @return bool ファイルの読込に成功した場合はtrue、失敗した場合はfalseを返却する。
+     * @note 呼出し以降の各read系メソッドはファイルを開かず、保持しているドキュメントから値を返却する。
+     *       ファイルが存在しない場合は空のドキュメントを保持する。
+     */
+    bool load()
+    {
+        std::lock_guard<Mutex> lock(write_mutex_);
+        return load_document();
+    }
+
+    /**
+     * @fn reload_if_changed
+     * @brief iniファイルが変更されている場合のみ再読込を行うメソッド
+     * @return bool 再読込を行った場合はtrueを返却する。
+     * @note 変更の有無はファイルの更新日時とサイズにより判定する。ドキュメントを保持していない場合は読込を行う。
+     *       再読込中も他スレッドからのread系メソッドは直前のドキュメントを参照して値を返却する。
+     */
+    bool reload_if_changed()
+    {
+        std::lock_guard<Mutex> lock(write_mutex_);
+        std::shared_ptr<const Document> document = document_.load();
+        if (document && is_current(*document))
+            return false;
+        load_document();
+        return true;
+    }
+
+    /**
+     * @fn reload
+     * @brief iniファイルを再度読み込み、保持しているドキュメントを置き換えるメソッド
+     * @return bool ファイルの読込に成功した場合はtrue、失敗した場合はfalseを返却する。
+     */
+    bool reload()
+    {
+        return load();
+    }
+
+    /**
+     * @fn load_async
+     * @brief @ref load を専用スレッドで実行するメソッド
+     * @return std::future<bool> @ref load の戻り値を受け取るfuture
+     * @note 呼出し元スレッドではファイル入出力を行わずに返却する。専用スレッドは初回の呼出し時に開始し、
+     *       @ref load_async および @ref Transaction::commit_async により登録した処理を登録順に1つずつ実行する。
+     *       インスタンスの破棄時は登録済みの処理を全て実行し終えるまで待機する。
+     */
+    std::future<bool> load_async()
+    {
+        return post_async([this] { return load(); });
+    }
+
+    /**
+     * @fn load_async
+     * @brief @ref load を専用スレッドで実行し、完了時にcallbackを呼び出すメソッド
+     * @param std::function<void(bool)> callback @ref load の戻り値を受け取る完了通知
+     * @note callbackは専用スレッドから呼び出すため、長時間処理を止めたり例外を送出したりしないこと。
+     */
+    void load_async(const std::function<void(bool)>& callback)
+    {
+        executor_.post([this, callback] { callback(load()); });
+    }
+
+    /**
+     * @fn flush
+     * @brief 遅延書込によりファイルへ未反映の書込内容を書き込むメソッド
+     * @return bool 書込成功時、もしくは未反映の書込内容が無い場合はtrue、失敗した場合はfalseを返却する。
+     * @note 失敗した場合は書込内容を保持し、次回の書込時に改めて書き込む。
+     */
+    bool flush() const
+    {
+        std::lock_guard<Mutex> lock(write_mutex_);
+        return flush_dirty();
+    }
+
+    /**
+     * @fn unload
+     * @brief 保持しているドキュメントを破棄するメソッド
+     * @note 呼出し以降の各read系メソッドは呼出しの都度ファイルを開く動作に戻る。
+     */
+    void unload()
+    {
+        document_.store(nullptr);
+    }
+
+    /**
+     * @fn is_loaded
+     * @brief ドキュメントを保持しているかどうかの取得メソッド
+     * @return bool @ref load によりドキュメントを保持している場合はtrueを返却する。
+     */
+    bool is_loaded() const
+    {
+        return document_.load() != nullptr;
+    }
+
+    /**
+     * @fn publish
+     * @brief 保持しているドキュメントを他プロセスから参照できるよう共有メモリへ公開するメソッド
+     * @param std::string name 共有メモリの名前(POSIXでは'/'で始まり他に'/'を含まない名前)
+     * @return bool 公開に成功した場合はtrue、失敗した場合はfalseを返却する。
+     * @note ドキュメントを保持していない場合は読み込んだ上で公開する。以降は @ref load・@ref reload_if_changed および
+     *       write系メソッドによりドキュメントが差し替わる毎に新たな世代として公開し直す。
+     *       内容は @ref set_cache_path のキャッシュファイルと同一の形式で格納するため、参照側と区切り文字・
+     *       コメント行の先頭文字列を揃えること。POSIXではプロセスの終了後も @ref unpublish を呼び出すまで公開を続ける。
+     */
+    bool publish(const std::string& name)
+    {
+        std::lock_guard<Mutex> lock(write_mutex_);
+        published_name_ = name;
+        published_control_.reset();
+        published_image_.reset();
+        if (!document_.load())
+            return load_document() && document_.load() && published_image_;
+        return publish_document();
+    }
+
+    /**
+     * @fn unpublish
+     * @brief @ref publish による公開を終了し、共有メモリの名前を削除するメソッド
+     * @note 参照中のプロセスはマップを解放するまで最後に公開した内容を参照できる。
+     */
+    void unpublish()
+    {
+        std::lock_guard<Mutex> lock(write_mutex_);
+        if (published_control_)
+        {
+            const SharedControl* control = reinterpret_cast<const SharedControl*>(published_control_->data());
+            SharedSegment::remove(shared_image_name(published_name_, control->generation.load(std::memory_order_relaxed)));
+            SharedSegment::remove(published_name_);
+        }
+        published_name_.clear();
+        published_control_.reset();
+        published_image_.reset();
+    }
+
+    /**
+     * @fn attach
+     * @brief 他プロセスが @ref publish で公開したドキュメントを読取専用で参照するメソッド
+     * @param std::string name 公開側が指定した共有メモリの名前
+     * @return bool 参照に成功した場合はtrue、未公開もしくは解析規則が一致しない場合はfalseを返却する。
+     * @note 呼出し以降の各read系メソッドは共有メモリ上のドキュメントから値を返却し、iniファイルを開かない。
+     *       @ref reload_if_changed (および @ref Watcher)は公開側の世代のみを比較し、更新されている場合は最新の世代へ切り替える。
+     *       参照中はwrite系メソッドを使用しないこと。参照中に解析規則(区切り文字・コメント行の先頭文字列)を変更すると
+     *       参照し直し、公開側の解析規則と一致しない場合は参照中のドキュメントを破棄する(改めて参照した場合と同一の結果となる)。
+     */
+    bool attach(const std::string& name)
+    {
+        std::lock_guard<Mutex> lock(write_mutex_);
+        shared_name_ = name;
+        shared_control_.reset();
+        return attach_document();
+    }
+
+    /**
+     * @fn detach
+     * @brief @ref attach による参照を終了し、保持しているドキュメントを破棄するメソッド
+     */
+    void detach()
+    {
+        std::lock_guard<Mutex> lock(write_mutex_);
+        shared_name_.clear();
+        shared_control_.reset();
+        document_.store(nullptr);
+    }
+
+    /**
+     * @fn read_bool
+     * @brief 真理値取得メソッド
+     * @param StringRef section_name []で囲まれたセクション名
+     * @param StringRef field_name 取得したいフィールド名
+     * @param bool default_value 読取失敗時のデフォルト値
+     * @return bool 読取成功時は読み取った値を、失敗した場合はデフォルト値を返却する。
+     * @note 真理値を表現文字列としては "true" もしくは "false" とする。(大文字/小文字は問わない。)
+     */
+    bool read_bool(const StringRef& section_name, const StringRef& field_name, const bool& default_value) const
+    {
+        bool value;
+        if (!try_get_typed(section_name, field_name, value))
+            return default_value;
+        return value;
+    }
+
+    /**
+     * @fn read_int
+     * @brief 整数値取得メソッド
+     * @param StringRef section_name []で囲まれたセクション名
+     * @param StringRef field_name 取得したいフィールド名
+     * @param int default_value 読取失敗時のデフォルト値
+     * @return int 読取成功時は読み取った値を、失敗した場合はデフォルト値を返却する。
+     */
+    int read_int(const StringRef& section_name, const StringRef& field_name, const int& default_value) const
+    {
+        int value;
+        if (!try_get_typed(section_name, field_name, value))
+            return default_value;
+        return value;
+    }
+
+    /**
+     * @fn read_double
+     * @brief 浮動小数点値取得メソッド
+     * @param StringRef section_name []で囲まれたセクション名
+     * @param StringRef field_name 取得したいフィールド名
+     * @param double default_value 読取失敗時のデフォルト値
+     * @return double 読取成功時は読み取った値を、失敗した場合はデフォルト値を返却する。
+     */ 
+    double read_double(const StringRef& section_name, const StringRef& field_name, const double& default_value) const
+    {
+        double value;
+        if (!try_get_typed(section_name, field_name, value))
+            return default_value;
+        return value;
+    }
+
+    /**
+     * @fn read_str
+     * @brief 文字列取得メソッド
+     * @param StringRef section_name []で囲まれたセクション名
+     * @param StringRef field_name 取得したいフィールド名
+     * @param std::string default_value 読取失敗時のデフォルト値
+     * @return std::string 読取成功時は読み取った値を、失敗した場合はデフォルト値を返却する。
+     */ 
+    std::string read_str(const StringRef& section_name, const StringRef& field_name, const std::string& default_value) const
+    {
+        std::shared_ptr<const Document> document;
+        std::string storage;
+        StringRef str("", 0);
+        if (!try_get_value(section_name, field_name, document, storage, str))
+            return default_value;
+        return std::string(str.data(), str.size());
+    }
+
+#if INI_HAS_CXX17
+    /**
+     * @fn read_view
+     * @brief 文字列を複製せずに参照する取得メソッド
+     * @param StringRef section_name []で囲まれたセクション名
+     * @param StringRef field_name 取得したいフィールド名
+     * @return std::optional<std::string_view> 読取成功時は値への参照を、失敗した場合はstd::nulloptを返却する。
+     * @note @ref load によりドキュメントを保持している場合のみ値を返却する。
+     *       返却した参照は次の @ref load / @ref reload / write系メソッド呼出しまで有効とする。
+     *       @ref Watcher による監視中は再読込により参照が無効になるため使用しないこと。
+     */
+    std::optional<std::string_view> read_view(const StringRef& section_name, const StringRef& field_name) const
+    {
+        std::shared_ptr<const Document> document = document_.load();
+        if (!document)
+            return std::nullopt;
+
+        const Document::Entry* entry = document->find(section_name, field_name);
+        if (entry == nullptr || entry->value.len == 0)
+            return std::nullopt;
+        return std::string_view(document->data + entry->value.pos, entry->value.len);
+    }
+#endif
+
+    /**
+     * @fn read_bool
+     * @brief 読取キーを用いた真理値取得メソッド
+     * @param Key key 取得したいセクション名・フィールド名の読取キー
+     * @param bool default_value 読取失敗時のデフォルト値
+     * @return bool 読取成功時は読み取った値を、失敗した場合はデフォルト値を返却する。
+     */
+    bool read_bool(Key& key, const bool& default_value) const
+    {
+        bool value;
+        if (!try_get_typed(key, value))
+            return default_value;
+        return value;
+    }
+
+    /**
+     * @fn read_int
+     * @brief 読取キーを用いた整数値取得メソッド
+     * @param Key key 取得したいセクション名・フィールド名の読取キー
+     * @param int default_value 読取失敗時のデフォルト値
+     * @return int 読取成功時は読み取った値を、失敗した場合はデフォルト値を返却する。
+     */
+    int read_int(Key& key, const int& default_value) const
+    {
+        int value;
+        if (!try_get_typed(key, value))
+            return default_value;
+        return value;
+    }
+
+    /**
+     * @fn read_double
+     * @brief 読取キーを用いた浮動小数点値取得メソッド
+     * @param Key key 取得したいセクション名・フィールド名の読取キー
+     * @param double default_value 読取失敗時のデフォルト値
+     * @return double 読取成功時は読み取った値を、失敗した場合はデフォルト値を返却する。
+     */
+    double read_double(Key& key, const double& default_value) const
+    {
+        double value;
+        if (!try_get_typed(key, value))
+            return default_value;
+        return value;
+    }
+
+    /**
+     * @fn read_str
+     * @brief 読取キーを用いた文字列取得メソッド
+     * @param Key key 取得したいセクション名・フィールド名の読取キー
+     * @param std::string default_value 読取失敗時のデフォルト値
+     * @return std::string 読取成功時は読み取った値を、失敗した場合はデフォルト値を返却する。
+     */
+    std::string read_str(Key& key, const std::string& default_value) const
+    {
+        std::shared_ptr<const Document> document = document_.load();
+        if (!document)
+            return read_str(key.section_, key.field_, default_value);
+
+        const Document::Entry* entry = bind(*document, key);
+        record_lookup(entry != nullptr && entry->value.len != 0);
+        if (entry == nullptr || entry->value.len == 0)
+            return default_value;
+        return std::string(document->data + entry->value.pos, entry->value.len);
+    }
+
+    /**
+     * @fn intern
+     * @brief セクション名・フィールド名の識別番号の取得メソッド
+     * @param StringRef name セクション名もしくはフィールド名
+     * @return Symbol 名前の識別番号(初めて指定した名前には新たな番号を割り当てる)
+     * @note 名前は一度だけ複製して保持し、セクション名・フィールド名で共通の番号を用いる。
+     */
+    Symbol intern(const StringRef& name) const
+    {
+        return Symbol(symbols_->intern(name));
+    }
+
+    /**
+     * @fn name_of
+     * @brief 識別番号に対応する名前の取得メソッド
+     * @param Symbol symbol @ref intern で取得した識別番号
+     * @return StringRef 名前(無効な識別番号の場合は空文字列)。参照先はインスタンスの破棄まで有効とする。
+     */
+    StringRef name_of(const Symbol& symbol) const
+    {
+        return symbols_->name(symbol.id());
+    }
+
+    /**
+     * @fn read_bool
+     * @brief 識別番号を用いた真理値取得メソッド
+     * @param Symbol section_name セクション名の識別番号
+     * @param Symbol field_name フィールド名の識別番号
+     * @param bool default_value 読取失敗時のデフォルト値
+     * @return bool 読取成功時は読み取った値を、失敗した場合はデフォルト値を返却する。
+     * @note ドキュメントを保持している場合は文字列の比較を行わず、識別番号のみを比較して検索する。
+     */
+    bool read_bool(const Symbol& section_name, const Symbol& field_name, const bool& default_value) const
+    {
+        bool value;
+        if (!try_get_typed(section_name, field_name, value))
+            return default_value;
+        return value;
+    }
+
+    /**
+     * @fn read_int
+     * @brief 識別番号を用いた整数値取得メソッド
+     * @see read_bool(const Symbol&, const Symbol&, const bool&)
+     */
+    int read_int(const Symbol& section_name, const Symbol& field_name, const int& default_value) const
+    {
+        int value;
+        if (!try_get_typed(section_name, field_name, value))
+            return default_value;
+        return value;
+    }
+
+    /**
+     * @fn read_double
+     * @brief 識別番号を用いた浮動小数点値取得メソッド
+     * @see read_bool(const Symbol&, const Symbol&, const bool&)
+     */
+    double read_double(const Symbol& section_name, const Symbol& field_name, const double& default_value) const
+    {
+        double value;
+        if (!try_get_typed(section_name, field_name, value))
+            return default_value;
+        return value;
+    }
+
+    /**
+     * @fn read_str
+     * @brief 識別番号を用いた文字列取得メソッド
+     * @see read_bool(const Symbol&, const Symbol&, const bool&)
+     */
+    std::string read_str(const Symbol& section_name, const Symbol& field_name, const std::string& default_value) const
+    {
+        std::string value;
+        if (!try_get_typed(section_name, field_name, value))
+            return default_value;
+        return value;
+    }
+
+    /**
+     * @fn read_section
+     * @brief セクション内の全フィールドの一括取得メソッド
+     * @param StringRef section_name []で囲まれたセクション名
+     * @param std::vector<std::pair<std::string, std::string>> fields フィールド名と値の組の格納先(呼出し時に内容を破棄する)
+     * @return std::size_t 取得したフィールド数
+     * @note フィールドはファイル上の出現順に格納する。同一フィールドが複数存在する場合は @ref read_str と同じく
+     *       最初のものを採用し、値が空のフィールドは格納しない。ドキュメントを保持していない場合もファイルの走査は一度のみ行う。
+     */
+    std::size_t read_section(const StringRef& section_name, std::vector<std::pair<std::string, std::string>>& fields) const
+    {
+        fields.clear();
+        std::shared_ptr<const Document> document = complete_document(document_.load());
+        if (!document)
+        {
+            struct Collector : Handler
+            {
+                const StringRef& section;
+                std::vector<std::pair<std::string, std::string>>& fields;
+                std::unordered_map<std::string, bool> seen;
+
+                Collector(const StringRef& section, std::vector<std::pair<std::string, std::string>>& fields)
+                 :  section(section), fields(fields)
+                {}
+
+                bool on_field(const StringRef& section_name, const StringRef& field_name, const StringRef& value) override
+                {
+                    if (!section.equals(section_name.data(), section_name.size()))
+                        return true;
+                    if (!seen.emplace(std::string(field_name.data(), field_name.size()), true).second || value.size() == 0)
+                        return true;
+                    fields.emplace_back(std::string(field_name.data(), field_name.size()), std::string(value.data(), value.size()));
+                    return true;
+                }
+            };
+
+            Collector collector(section_name, fields);
+            parse(collector);
+            return fields.size();
+        }
+
+        // 該当するセクション行を索引から辿り、各セクション行のエントリは連続した範囲として読み取る。
+        for (const Document::Section* section = document->find_section(section_name); section != nullptr;
+             section = (section->next != 0) ? &document->sections[section->next - 1] : nullptr)
+        {
+            const Document::Entry* last = document->entries.data() + section->first + section->count;
+            for (const Document::Entry* entry = document->entries.data() + section->first; entry != last; ++entry)
+            {
+                if (entry->value.len == 0)
+                    continue;
+                const StringRef field(document->data + entry->field.pos, entry->field.len);
+                if (document->find(section_name, field, entry->hash) != entry)
+                    continue;
+                fields.emplace_back(std::string(field.data(), field.size()), std::string(document->data + entry->value.pos, entry->value.len));
+            }
+        }
+        return fields.size();
+    }
+
+    /**
+     * @fn read_fields
+     * @brief 複数フィールドの文字列の一括取得メソッド
+     * @param std::vector<std::pair<std::string, std::string>> keys 取得したいセクション名とフィールド名の組
+     * @param std::vector<std::string> values keysと同じ並びで値を格納する格納先(呼出し時に内容を破棄する)
+     * @param std::string default_value 読取失敗時のデフォルト値
+     * @return std::size_t 値を取得できたフィールド数
+     * @note ドキュメントを保持していない場合も、ファイルの走査はフィールド数によらず一度のみ行う。
+     */
+    std::size_t read_fields(const std::vector<std::pair<std::string, std::string>>& keys, std::vector<std::string>& values,
+                            const std::string& default_value) const
+    {
+        values.assign(keys.size(), default_value);
+        std::size_t found = 0;
+        std::shared_ptr<const Document> document = document_.load();
+        if (!document)
+        {
+            // 同一のセクション・フィールドは最初の出現で値が確定するため、確定済みの組は以降の行で照合しない。
+            struct Collector : Handler
+            {
+                const std::vector<std::pair<std::string, std::string>>& keys;
+                std::vector<std::string>& values;
+                std::size_t& found;
+                std::unordered_multimap<std::uint64_t, std::size_t> pending;
+
+                Collector(const std::vector<std::pair<std::string, std::string>>& keys, std::vector<std::string>& values, std::size_t& found)
+                 :  keys(keys), values(values), found(found)
+                {
+                    for (std::size_t i = 0; i < keys.size(); ++i)
+                        pending.emplace(hash_key(keys[i].first, keys[i].second), i);
+                }
+
+                bool on_field(const StringRef& section_name, const StringRef& field_name, const StringRef& value) override
+                {
+                    auto range = pending.equal_range(hash_key(section_name, field_name));
+                    for (auto it = range.first; it != range.second;)
+                    {
+                        const std::size_t index = it->second;
+                        if (!section_name.equals(keys[index].first) || !field_name.equals(keys[index].second))
+                        {
+                            ++it;
+                            continue;
+                        }
+                        if (value.size() != 0)
+                        {
+                            values[index].assign(value.data(), value.size());
+                            ++found;
+                        }
+                        it = pending.erase(it);
+                    }
+                    return !pending.empty();
+                }
+            };
+
+            if (!keys.empty())
+            {
+                Collector collector(keys, values, found);
+                parse(collector);
+            }
+            return found;
+        }
+
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            StringRef value("", 0);
+            if (!find_value(*document, keys[i].first, keys[i].second, value))
+                continue;
+            values[i].assign(value.data(), value.size());
+            ++found;
+        }
+        return found;
+    }
+
+    /**
+     * @struct Binding
+     * @brief 構造体のメンバとセクション名・フィールド名・デフォルト値の対応付け
+     * @note @ref bind_field により生成する。ハッシュ値は生成時に算出するため、constexpr として宣言した場合は
+     *       コンパイル時に確定する。
+     */
+    template <class Struct, class T, class Default>
+    struct Binding
+    {
+        const char* section;
+        std::size_t section_size;
+        const char* field;
+        std::size_t field_size;
+        T Struct::* member;
+        Default default_value;
+        std::uint64_t hash;
+    };
+
+    /**
+     * @fn bind_field
+     * @brief 構造体のメンバとセクション名・フィールド名の対応付けの生成メソッド
+     * @param const char* section_name []で囲まれたセクション名
+     * @param const char* field_name 取得したいフィールド名
+     * @param T Struct::* member 値を格納するメンバ(bool/int/double/std::string)
+     * @param Default default_value 読取失敗時のデフォルト値
+     */
+    template <class Struct, class T, class Default>
+    static constexpr Binding<Struct, T, Default> bind_field(const char* section_name, const char* field_name, T Struct::* member, const Default default_value)
+    {
+        return Binding<Struct, T, Default>{ section_name, literal_size(section_name), field_name, literal_size(field_name), member, default_value,
+                                            hash_literal(field_name, (hash_literal(section_name, 0xcbf29ce484222325ULL) ^ 0xffu) * 0x100000001b3ULL) };
+    }
+
+private:
+
+    template <class... Bindings>
+    struct BindingList;
+
+public:
+
+    /**
+     * @class Schema
+     * @brief 構造体の各メンバへの対応付けをまとめたスキーマ
+     * @note @ref make_schema により生成し、@ref read_struct で構造体全体を一度に読み込む。
+     *       各メンバの型毎の変換はテンプレートにより静的に選択され、実行時の型判定は行わない。
+     */
+    template <class Struct, class... Bindings>
+    class Schema
+    {
+    public:
+        constexpr explicit Schema(const Bindings&... bindings)
+         :  bindings_(bindings...)
+        {}
+
+        static constexpr std::size_t size() { return sizeof...(Bindings); }
+
+    private:
+        friend class Ini;
+        BindingList<Bindings...> bindings_;
+    };
+
+    /**
+     * @fn make_schema
+     * @brief 構造体Structのスキーマの生成メソッド
+     * @param Bindings bindings @ref bind_field により生成した対応付け
+     * @note 使用例
+     *       @code
+     *       struct Config { int port; std::string host; };
+     *       constexpr auto schema = Ini::make_schema<Config>(Ini::bind_field("NET", "PORT", &Config::port, 8080),
+     *                                                        Ini::bind_field("NET", "HOST", &Config::host, "localhost"));
+     *       @endcode
+     */
+    template <class Struct, class... Bindings>
+    static constexpr Schema<Struct, Bindings...> make_schema(const Bindings&... bindings)
+    {
+        return Schema<Struct, Bindings...>(bindings...);
+    }
+
+    /**
+     * @fn read_struct
+     * @brief スキーマに従い構造体の全メンバを一括で読み込むメソッド
+     * @param Schema schema 読み込むメンバの対応付け
+     * @param Struct object 読込先の構造体
+     * @return std::size_t ファイルから値を取得できたメンバ数(残りのメンバにはデフォルト値を格納する)
+     * @note ドキュメントを保持している場合は予め算出したハッシュ値でメンバ毎に一度だけ検索し、
+     *       保持していない場合はファイルを一度だけ走査する。読取規則は各read系メソッドと同一とする。
+     */
+    template <class Struct, class... Bindings>
+    std::size_t read_struct(const Schema<Struct, Bindings...>& schema, Struct& object) const
+    {
+        std::shared_ptr<const Document> document = document_.load();
+        if (document)
+            return read_bindings(*document, schema.bindings_, object);
+
+        struct Collector : Handler
+        {
+            const BindingList<Bindings...>& bindings;
+            Struct& object;
+            std::vector<bool> seen;
+            std::size_t remaining;
+            std::size_t found;
+
+            Collector(const BindingList<Bindings...>& bindings, Struct& object)
+             :  bindings(bindings), object(object), seen(sizeof...(Bindings), false), remaining(sizeof...(Bindings)), found(0)
+            {}
+
+            bool on_field(const StringRef& section_name, const StringRef& field_name, const StringRef& value) override
+            {
+                assign_line(bindings, 0, hash_key(section_name, field_name), section_name, field_name, value, object, seen, remaining, found);
+                return remaining != 0;
+            }
+        };
+
+        assign_defaults(schema.bindings_, object);
+        Collector collector(schema.bindings_, object);
+        if (sizeof...(Bindings) != 0)
+            parse(collector);
+        return collector.found;
+    }
+
+    /**
+     * @fn write_bool
+     * @brief 真理値書込メソッド
+     * @param std::string section_name []で囲まれたセクション名
+     * @param std::string field_name 取得したいフィールド名
+     * @param bool value 書込値
+     * @note 既に対象のセクション・フィールドが存在していた場合上書きする。
+     */
+    bool write_bool(const std::string& section_name, const std::string& field_name, const bool &value) const
+    {
+        return set_field(section_name, field_name, format_bool(value));
+    }
+
+    /**
+     * @fn write_int
+     * @brief 整数値書込メソッド
+     * @param std::string section_name []で囲まれたセクション名
+     * @param std::string field_name 取得したいフィールド名
+     * @param int value 書込値
+     * @note 既に対象のセクション・フィールドが存在していた場合上書きする。
+     */
+    bool write_int(const std::string& section_name, const std::string& field_name, const int& value) const
+    {
+        return set_field(section_name, field_name, format_int(value));
+    }
+
+    /**
+     * @fn write_double
+     * @brief 浮動小数点値書込メソッド
+     * @param std::string section_name []で囲まれたセクション名
+     * @param std::string field_name 取得したいフィールド名
+     * @param double value 書込値
+     * @note 既に対象のセクション・フィールドが存在していた場合上書きする。
+     */
+    bool write_double(const std::string& section_name, const std::string& field_name, const double& value) const
+    {
+        return set_field(section_name, field_name, format_double(value));
+    }
+
+    /**
+     * @fn write_double
+     * @brief 浮動小数点値書込メソッド
+     * @param std::string section_name []で囲まれたセクション名
+     * @param std::string field_name 取得したいフィールド名
+     * @param std::string value 書込値
+     * @note 既に対象のセクション・フィールドが存在していた場合上書きする。
+     */
+    bool write_str(const std::string& section_name, const std::string& field_name, const std::string& value) const
+    {
+        return set_field(section_name, field_name, value);
+    }
+
+private:
+
+    struct Document;
+
+    struct FieldUpdate
+    {
+        std::string section;
+        std::string field;
+        std::string value;
+    };
+
+public:
+
+    /**
+     * @class Transaction
+     * @brief 複数フィールドの書込をまとめて反映するトランザクションクラス
+     * @note 各write系メソッドはメモリ上に書込内容を蓄積するのみで、@ref commit 呼出し時に
+     *       ファイルの読込・再構築・書込をそれぞれ一度だけ行う。
+     */
+    class Transaction
+    {
+    public:
+
+        /**
+         * @fn write_bool
+         * @brief 真理値書込の登録メソッド
+         * @param std::string section_name []で囲まれたセクション名
+         * @param std::string field_name 書き込みたいフィールド名
+         * @param bool value 書込値
+         * @return Transaction& 書込登録後のトランザクションインスタンス
+         */
+        Transaction& write_bool(const std::string& section_name, const std::string& field_name, const bool& value)
+        {
+            return stage(section_name, field_name, Ini::format_bool(value));
+        }
+
+        /**
+         * @fn write_int
+         * @brief 整数値書込の登録メソッド
+         * @param std::string section_name []で囲まれたセクション名
+         * @param std::string field_name 書き込みたいフィールド名
+         * @param int value 書込値
+         * @return Transaction& 書込登録後のトランザクションインスタンス
+         */
+        Transaction& write_int(const std::string& section_name, const std::string& field_name, const int& value)
+        {
+            return stage(section_name, field_name, Ini::format_int(value));
+        }
+
+        /**
+         * @fn write_double
+         * @brief 浮動小数点値書込の登録メソッド
+         * @param std::string section_name []で囲まれたセクション名
+         * @param std::string field_name 書き込みたいフィールド名
+         * @param double value 書込値
+         * @return Transaction& 書込登録後のトランザクションインスタンス
+         */
+        Transaction& write_double(const std::string& section_name, const std::string& field_name, const double& value)
+        {
+            return stage(section_name, field_name, Ini::format_double(value));
+        }
+
+        /**
+         * @fn write_str
+         * @brief 文字列書込の登録メソッド
+         * @param std::string section_name []で囲まれたセクション名
+         * @param std::string field_name 書き込みたいフィールド名
+         * @param std::string value 書込値
+         * @return Transaction& 書込登録後のトランザクションインスタンス
+         */
+        Transaction& write_str(const std::string& section_name, const std::string& field_name, const std::string& value)
+        {
+            return stage(section_name, field_name, value);
+        }
+
+        /**
+         * @fn commit
+         * @brief 登録済みの書込内容をファイルへ反映するメソッド
+         * @return bool 書込成功時はtrue、失敗した場合はfalseを返却する。
+         * @note 同一のセクション・フィールドへの書込が複数登録されている場合は最後の値を反映する。
+         *       成功・失敗に関わらず登録済みの書込内容は破棄される。
+         */
+        bool commit()
+        {
+            bool result = updates_.empty() ? true : ini_->commit_fields(updates_);
+            updates_.clear();
+            return result;
+        }
+
+        /**
+         * @fn commit_async
+         * @brief 登録済みの書込内容を専用スレッドでファイルへ反映するメソッド
+         * @return std::future<bool> @ref commit の戻り値を受け取るfuture
+         * @note 書込内容は呼出し時にトランザクションから取り出すため、返却後はすぐに次の書込を登録できる。
+         *       専用スレッドの動作は @ref Ini::load_async と同一とする。
+         */
+        std::future<bool> commit_async()
+        {
+            std::shared_ptr<const std::vector<FieldUpdate>> updates = take();
+            const Ini* ini = ini_;
+            return ini_->post_async([ini, updates] { return updates->empty() ? true : ini->commit_fields(*updates); });
+        }
+
+        /**
+         * @fn commit_async
+         * @brief 登録済みの書込内容を専用スレッドでファイルへ反映し、完了時にcallbackを呼び出すメソッド
+         * @param std::function<void(bool)> callback @ref commit の戻り値を受け取る完了通知
+         * @note callbackは専用スレッドから呼び出すため、長時間処理を止めたり例外を送出したりしないこと。
+         */
+        void commit_async(const std::function<void(bool)>& callback)
+        {
+            std::shared_ptr<const std::vector<FieldUpdate>> updates = take();
+            const Ini* ini = ini_;
+            ini_->executor_.post([ini, updates, callback] { callback(updates->empty() ? true : ini->commit_fields(*updates)); });
+        }
+
+        /**
+         * @fn discard
+         * @brief 登録済みの書込内容をファイルへ反映せずに破棄するメソッド
+         */
+        void discard()
+        {
+            updates_.clear();
+        }
+
+        /**
+         * @fn size
+         * @brief 登録済みの書込件数の取得メソッド
+         * @return std::size_t 登録済みの書込件数
+         */
+        std::size_t size() const
+        {
+            return updates_.size();
+        }
+
+    private:
+        friend class Ini;
+
+        const Ini* ini_;
+        std::vector<FieldUpdate> updates_;
+
+        explicit Transaction(const Ini& ini)
+         :  ini_(&ini)
+        {}
+
+        Transaction& stage(const std::string& section_name, const std::string& field_name, const std::string& value)
+        {
+            FieldUpdate update = { section_name, field_name, value };
+            updates_.push_back(std::move(update));
+            return *this;
+        }
+
+        std::shared_ptr<const std::vector<FieldUpdate>> take()
+        {
+            std::shared_ptr<std::vector<FieldUpdate>> updates = std::make_shared<std::vector<FieldUpdate>>();
+            updates->swap(updates_);
+            return updates;
+        }
+    };
+
+    /**
+     * @fn begin_transaction
+     * @brief 複数フィールドの書込をまとめて反映するトランザクションの生成メソッド
+     * @return Transaction 書込内容が空のトランザクション
+     * @note トランザクションは生成元のインスタンスより先に破棄すること。
+     */
+    Transaction begin_transaction() const
+    {
+        return Transaction(*this);
+    }
+
+    /**
+     * @class Watcher
+     * @brief iniファイルの変更を一定周期で検知し、バックグラウンドで再読込を行う監視クラス
+     * @note 生成時に監視用スレッドを開始し、破棄時に停止する。各read系メソッドは監視中も
+     *       ファイル入出力を行わず、最大で監視周期分遅れて変更後の値を返却する。
+     *       監視は監視対象のインスタンスより先に破棄し、監視中は区切り文字等の設定を変更しないこと。
+     */
+    class Watcher
+    {
+    public:
+
+        /**
+         * @fn Watcher
+         * @brief コンストラクタ
+         * @param Ini ini 監視対象のパーサインスタンス
+         * @param std::chrono::milliseconds interval 変更の確認周期
+         */
+        Watcher(Ini& ini, const std::chrono::milliseconds& interval)
+         :  ini_(&ini), interval_(interval), stopping_(false)
+        {
+            ini_->reload_if_changed();
+            thread_ = std::thread(&Watcher::run, this);
+        }
+
+        Watcher(const Watcher&) = delete;
+        Watcher& operator=(const Watcher&) = delete;
+
+        ~Watcher()
+        {
+            stop();
+        }
+
+        /**
+         * @fn stop
+         * @brief 監視を停止するメソッド
+         */
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            condition_.notify_all();
+            if (thread_.joinable())
+                thread_.join();
+        }
+
+    private:
+        Ini* ini_;
+        std::chrono::milliseconds interval_;
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        bool stopping_;
+        std::thread thread_;
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!condition_.wait_for(lock, interval_, [this]{ return stopping_; }))
+            {
+                lock.unlock();
+                ini_->reload_if_changed();
+                lock.lock();
+            }
+        }
+    };
+
+    /**
+     * @class Reader
+     * @brief 読込済みドキュメントを排他なしで参照するスレッド毎の読取クラス
+     * @note 取得したドキュメントを保持し、差替えが無い限り共有の参照カウントにも触れずに値を返却する。
+     *       差替えは世代番号の比較のみで検知し、次の読取時に最新のドキュメントへ追従する。
+     *       1つのインスタンスを複数スレッドで共有せず、スレッド毎に生成すること。
+     *       ドキュメントを保持していない場合は生成元インスタンスのread系メソッドと同様にファイルを走査する。
+     */
+    class Reader
+    {
+    public:
+
+        /**
+         * @fn Reader
+         * @brief コンストラクタ
+         * @param Ini ini 読取対象のパーサインスタンス
+         */
+        explicit Reader(const Ini& ini)
+         :  ini_(&ini), generation_(ini.document_.generation()), document_(ini.document_.load())
+        {}
+
+        /**
+         * @fn read_bool
+         * @brief 真理値取得メソッド
+         * @see Ini::read_bool
+         */
+        bool read_bool(const StringRef& section_name, const StringRef& field_name, const bool& default_value)
+        {
+            bool value;
+            if (!refresh())
+                return ini_->read_bool(section_name, field_name, default_value);
+            if (!ini_->find_typed(*document_, section_name, field_name, value))
+                return default_value;
+            return value;
+        }
+
+        /**
+         * @fn read_int
+         * @brief 整数値取得メソッド
+         * @see Ini::read_int
+         */
+        int read_int(const StringRef& section_name, const StringRef& field_name, const int& default_value)
+        {
+            int value;
+            if (!refresh())
+                return ini_->read_int(section_name, field_name, default_value);
+            if (!ini_->find_typed(*document_, section_name, field_name, value))
+                return default_value;
+            return value;
+        }
+
+        /**
+         * @fn read_double
+         * @brief 浮動小数点値取得メソッド
+         * @see Ini::read_double
+         */
+        double read_double(const StringRef& section_name, const StringRef& field_name, const double& default_value)
+        {
+            double value;
+            if (!refresh())
+                return ini_->read_double(section_name, field_name, default_value);
+            if (!ini_->find_typed(*document_, section_name, field_name, value))
+                return default_value;
+            return value;
+        }
+
+        /**
+         * @fn read_str
+         * @brief 文字列取得メソッド
+         * @see Ini::read_str
+         */
+        std::string read_str(const StringRef& section_name, const StringRef& field_name, const std::string& default_value)
+        {
+            StringRef str("", 0);
+            if (!refresh())
+                return ini_->read_str(section_name, field_name, default_value);
+            if (!ini_->find_value(*document_, section_name, field_name, str))
+                return default_value;
+            return std::string(str.data(), str.size());
+        }
+
+#if INI_HAS_CXX17
+        /**
+         * @fn read_view
+         * @brief 文字列を複製せずに参照する取得メソッド
+         * @note 返却した参照は、このインスタンスで次にread系メソッドを呼び出すまで有効とする。
+         * @see Ini::read_view
+         */
+        std::optional<std::string_view> read_view(const StringRef& section_name, const StringRef& field_name)
+        {
+            StringRef str("", 0);
+            if (!refresh() || !ini_->find_value(*document_, section_name, field_name, str))
+                return std::nullopt;
+            return std::string_view(str.data(), str.size());
+        }
+#endif
+
+        /**
+         * @fn read_bool
+         * @brief 読取キーを用いた真理値取得メソッド
+         * @see Ini::read_bool
+         */
+        bool read_bool(Key& key, const bool& default_value)
+        {
+            bool value;
+            if (!refresh())
+                return ini_->read_bool(key, default_value);
+            if (!ini_->find_typed(*document_, key, value))
+                return default_value;
+            return value;
+        }
+
+        /**
+         * @fn read_int
+         * @brief 読取キーを用いた整数値取得メソッド
+         * @see Ini::read_int
+         */
+        int read_int(Key& key, const int& default_value)
+        {
+            int value;
+            if (!refresh())
+                return ini_->read_int(key, default_value);
+            if (!ini_->find_typed(*document_, key, value))
+                return default_value;
+            return value;
+        }
+
+        /**
+         * @fn read_double
+         * @brief 読取キーを用いた浮動小数点値取得メソッド
+         * @see Ini::read_double
+         */
+        double read_double(Key& key, const double& default_value)
+        {
+            double value;
+            if (!refresh())
+                return ini_->read_double(key, default_value);
+            if (!ini_->find_typed(*document_, key, value))
+                return default_value;
+            return value;
+        }
+
+        /**
+         * @fn read_str
+         * @brief 読取キーを用いた文字列取得メソッド
+         * @see Ini::read_str
+         */
+        std::string read_str(Key& key, const std::string& default_value)
+        {
+            if (!refresh())
+                return ini_->read_str(key, default_value);
+            const Document::Entry* entry = Ini::bind(*document_, key);
+            ini_->record_lookup(entry != nullptr && entry->value.len != 0);
+            if (entry == nullptr || entry->value.len == 0)
+                return default_value;
+            return std::string(document_->data + entry->value.pos, entry->value.len);
+        }
+
+    private:
+        const Ini* ini_;
+        std::uint64_t generation_;
+        std::shared_ptr<const Document> document_;
+
+        bool refresh()
+        {
+            const std::uint64_t generation = ini_->document_.generation();
+            if (generation != generation_)
+            {
+                document_ = ini_->document_.load();
+                generation_ = generation;
+            }
+            return document_ != nullptr;
+        }
+    };
+
+    /**
+     * @fn reader
+     * @brief 排他なしで読取を行うスレッド毎の読取インスタンスの生成メソッド
+     * @return Reader 読取インスタンス
+     */
+    Reader reader() const
+    {
+        return Reader(*this);
+    }
+
+    /**
+     * @class Layered
+     * @brief 優先度の異なる複数のiniファイルを重ね合わせて参照する読取クラス
+     * @note 後に指定したファイルほど優先度が高く、同一のセクション・フィールドは値が空でない最も優先度の高いファイルの値を返却する。
+     *       全ファイルのフィールドを1つの索引にまとめるため、各read系メソッドはファイル数によらず一度の検索で値を返却する。
+     *       各ファイルは個別に再読込でき、索引はそのファイルが持つフィールドの分のみを更新する。
+     *       読込・再読込中は他スレッドから読み取らないこと。
+     */
+    class Layered
+    {
+    public:
+
+        /**
+         * @fn Layered
+         * @brief コンストラクタ
+         * @param std::vector<std::string> file_paths iniファイルへのパス(優先度の低い順)
+         */
+        explicit Layered(const std::vector<std::string>& file_paths)
+         :  documents_(file_paths.size())
+        {
+            layers_.reserve(file_paths.size());
+            for (const auto& file_path : file_paths)
+                layers_.emplace_back(file_path);
+        }
+
+        /**
+         * @fn layer
+         * @brief 各ファイルのパーサインスタンスの取得メソッド
+         * @param std::size_t index コンストラクタで指定した順の番号
+         * @return Ini& 区切り文字等の設定を変更するためのパーサインスタンス
+         * @note 設定の変更後は @ref reload でそのファイルを読み込み直すこと。
+         */
+        Ini& layer(const std::size_t index)
+        {
+            return layers_[index];
+        }
+
+        std::size_t size() const
+        {
+            return layers_.size();
+        }
+
+        /**
+         * @fn load
+         * @brief 全てのファイルを読み込み、索引を構築するメソッド
+         * @return bool 全てのファイルの読込に成功した場合はtrueを返却する。
+         * @note 読み込めなかったファイルはフィールドを持たないものとして扱う。
+         */
+        bool load()
+        {
+            bool result = true;
+            for (std::size_t i = 0; i < layers_.size(); ++i)
+            {
+                result = layers_[i].load() && result;
+                sync(i);
+            }
+            return result;
+        }
+
+        /**
+         * @fn reload
+         * @brief 指定のファイルのみを再度読み込み、索引のうちそのファイルの分を更新するメソッド
+         * @param std::size_t index コンストラクタで指定した順の番号
+         * @return bool ファイルの読込に成功した場合はtrueを返却する。
+         */
+        bool reload(const std::size_t index)
+        {
+            const bool result = layers_[index].reload();
+            sync(index);
+            return result;
+        }
+
+        /**
+         * @fn reload_if_changed
+         * @brief 変更されたファイルのみを再度読み込み、索引のうちそのファイルの分を更新するメソッド
+         * @return bool いずれかのファイルを再読込した場合はtrueを返却する。
+         */
+        bool reload_if_changed()
+        {
+            bool reloaded = false;
+            for (std::size_t i = 0; i < layers_.size(); ++i)
+            {
+                layers_[i].reload_if_changed();
+                reloaded = sync(i) || reloaded;
+            }
+            return reloaded;
+        }
+
+        /**
+         * @fn read_bool
+         * @brief 真理値取得メソッド
+         * @see Ini::read_bool
+         */
+        bool read_bool(const StringRef& section_name, const StringRef& field_name, const bool& default_value) const
+        {
+            return read_typed(section_name, field_name, default_value);
+        }
+
+        /**
+         * @fn read_int
+         * @brief 整数値取得メソッド
+         * @see Ini::read_int
+         */
+        int read_int(const StringRef& section_name, const StringRef& field_name, const int& default_value) const
+        {
+            return read_typed(section_name, field_name, default_value);
+        }
+
+        /**
+         * @fn read_double
+         * @brief 浮動小数点値取得メソッド
+         * @see Ini::read_double
+         */
+        double read_double(const StringRef& section_name, const StringRef& field_name, const double& default_value) const
+        {
+            return read_typed(section_name, field_name, default_value);
+        }
+
+        /**
+         * @fn read_str
+         * @brief 文字列取得メソッド
+         * @see Ini::read_str
+         */
+        std::string read_str(const StringRef& section_name, const StringRef& field_name, const std::string& default_value) const
+        {
+            return read_typed(section_name, field_name, default_value);
+        }
+
+    private:
+
+        /**
+         * @struct Winner
+         * @brief 索引に登録するフィールドの参照先(値を採用するファイルの番号とそのエントリの位置)
+         */
+        struct Winner
+        {
+            std::size_t layer;
+            std::size_t index;
+        };
+
+        typedef std::unordered_multimap<std::uint64_t, Winner> Index;
+
+        std::vector<Ini> layers_;
+        std::vector<std::shared_ptr<const Document>> documents_;
+        Index index_;
+
+        template <class T>
+        T read_typed(const StringRef& section_name, const StringRef& field_name, const T& default_value) const
+        {
+            const Index::const_iterator it = find(section_name, field_name, hash_key(section_name, field_name));
+            if (it == index_.end())
+                return default_value;
+            const Document& document = *documents_[it->second.layer];
+            T value;
+            if (!document.convert(document.entries[it->second.index], value))
+                return default_value;
+            return value;
+        }
+
+        Index::const_iterator find(const StringRef& section_name, const StringRef& field_name, const std::uint64_t hash) const
+        {
+            std::pair<Index::const_iterator, Index::const_iterator> range = index_.equal_range(hash);
+            for (Index::const_iterator it = range.first; it != range.second; ++it)
+            {
+                const Document& document = *documents_[it->second.layer];
+                const Document::Entry& entry = document.entries[it->second.index];
+                if (document.equals(entry.section, section_name) && document.equals(entry.field, field_name))
+                    return it;
+            }
+            return index_.end();
+        }
+
+        Index::iterator find(const StringRef& section_name, const StringRef& field_name, const std::uint64_t hash)
+        {
+            std::pair<Index::iterator, Index::iterator> range = index_.equal_range(hash);
+            for (Index::iterator it = range.first; it != range.second; ++it)
+            {
+                const Document& document = *documents_[it->second.layer];
+                const Document::Entry& entry = document.entries[it->second.index];
+                if (document.equals(entry.section, section_name) && document.equals(entry.field, field_name))
+                    return it;
+            }
+            return index_.end();
+        }
+
+        /**
+         * @fn sync
+         * @brief ファイルの保持しているドキュメントが索引の構築時から差し替わっている場合に、そのファイルの分の索引を更新するメソッド
+         * @return bool 索引を更新した場合はtrueを返却する。
+         * @note 旧ドキュメントのフィールドを索引から除いて下位のファイルの値に戻した後、新ドキュメントのフィールドを登録する。
+         */
+        bool sync(const std::size_t layer)
+        {
+            std::shared_ptr<const Document> document = complete_document(layers_[layer].document_.load());
+            if (document == documents_[layer])
+                return false;
+
+            if (documents_[layer])
+            {
+                const Document& previous = *documents_[layer];
+                for (std::size_t i = 0; i < previous.entries.size(); ++i)
+                {
+                    if (is_effective(previous, i))
+                        withdraw(layer, previous, i);
+                }
+            }
+
+            documents_[layer] = std::move(document);
+            if (documents_[layer])
+            {
+                const Document& current = *documents_[layer];
+                for (std::size_t i = 0; i < current.entries.size(); ++i)
+                {
+                    if (is_effective(current, i))
+                        enter(layer, current, i);
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @fn is_effective
+         * @brief エントリがそのファイル内で採用される(同一フィールドの最初の出現であり、値が空でない)かどうかの判定メソッド
+         */
+        static bool is_effective(const Document& document, const std::size_t index)
+        {
+            const Document::Entry& entry = document.entries[index];
+            if (entry.value.len == 0)
+                return false;
+            const StringRef section(document.data + entry.section.pos, entry.section.len);
+            const StringRef field(document.data + entry.field.pos, entry.field.len);
+            return document.find(section, field, entry.hash) == &entry;
+        }
+
+        void enter(const std::size_t layer, const Document& document, const std::size_t index)
+        {
+            const Document::Entry& entry = document.entries[index];
+            const StringRef section(document.data + entry.section.pos, entry.section.len);
+            const StringRef field(document.data + entry.field.pos, entry.field.len);
+            const Index::iterator it = find(section, field, entry.hash);
+            const Winner winner = { layer, index };
+            if (it == index_.end())
+                index_.emplace(entry.hash, winner);
+            else if (it->second.layer <= layer)
+                it->second = winner;
+        }
+
+        void withdraw(const std::size_t layer, const Document& document, const std::size_t index)
+        {
+            const Document::Entry& entry = document.entries[index];
+            const StringRef section(document.data + entry.section.pos, entry.section.len);
+            const StringRef field(document.data + entry.field.pos, entry.field.len);
+            const Index::iterator it = find(section, field, entry.hash);
+            if (it == index_.end() || it->second.layer != layer)
+                return;
+
+            // 下位のファイルのうち値が空でない最も優先度の高いものへ参照先を戻す。
+            for (std::size_t lower = layer; lower-- > 0;)
+            {
+                if (!documents_[lower])
+                    continue;
+                const Document& candidate = *documents_[lower];
+                const Document::Entry* found = candidate.find(section, field, entry.hash);
+                if (found == nullptr || found->value.len == 0)
+                    continue;
+                const Winner winner = { lower, static_cast<std::size_t>(found - candidate.entries.data()) };
+                it->second = winner;
+                return;
+            }
+            index_.erase(it);
+        }
+    };
+
+    /**
+     * @class Handler
+     * @brief @ref parse によるiniファイルの逐次解析で、各行の内容を受け取る通知先クラス
+     * @note 必要なメソッドのみを派生クラスで上書きする。各メソッドでfalseを返却すると解析を中止する。
+     *       引数の文字列は呼出し中のみ有効であるため、保持する場合は複製すること。
+     */
+    class Handler
+    {
+    public:
+        virtual ~Handler() {}
+
+        /**
+         * @fn on_section
+         * @brief セクション行の通知メソッド
+         * @param StringRef section_name []で囲まれたセクション名
+         */
+        virtual bool on_section(const StringRef& section_name)
+        {
+            (void)section_name;
+            return true;
+        }
+
+        /**
+         * @fn on_field
+         * @brief フィールド行の通知メソッド
+         * @param StringRef section_name フィールドが属するセクション名
+         * @param StringRef field_name フィールド名
+         * @param StringRef value 前後の空白を除いた値(空の場合もある)
+         */
+        virtual bool on_field(const StringRef& section_name, const StringRef& field_name, const StringRef& value)
+        {
+            (void)section_name;
+            (void)field_name;
+            (void)value;
+            return true;
+        }
+
+        /**
+         * @fn on_comment
+         * @brief コメント行の通知メソッド
+         * @param StringRef line コメント行の先頭文字列を含む、前後の空白を除いた行
+         */
+        virtual bool on_comment(const StringRef& line)
+        {
+            (void)line;
+            return true;
+        }
+    };
+
+    /**
+     * @fn parse
+     * @brief iniファイルを固定長の単位で読み込みながら解析し、各行の内容をhandlerへ通知するメソッド
+     * @param Handler handler 通知先
+     * @param std::size_t chunk_size 一度に読み込むバイト数
+     * @return bool ファイルを開けない場合、もしくは読込に失敗した場合はfalseを返却する。
+     * @note ファイル全体を保持せず、使用するメモリは chunk_size (1行がそれより長い場合はその行の長さ)に限られる。
+     *       gzip形式のファイルも読込単位毎に展開して解析し、展開した内容の全体は保持しない。
+     *       解析規則は @ref load と同一とし、不正な行を検出した時点で解析を終える。
+     *       保持しているドキュメントは参照・更新しない。
+     */
+    bool parse(Handler& handler, const std::size_t chunk_size = 64 * 1024) const
+    {
+        InputFile file;
+        if (!file.open(file_path_))
+            return false;
+        record(Instrumentation::FILE_OPENS);
+        const Stopwatch stopwatch(*this, Instrumentation::PARSE);
+
+        struct Dispatcher
+        {
+            Handler& handler;
+            std::string section;
+
+            bool on_section(const char* data, const Document::Span& name)
+            {
+                // 読込領域は次の読込で上書きされるため、以降のフィールド通知に用いるセクション名は複製して保持する。
+                section.assign(data + name.pos, name.len);
+                return handler.on_section(StringRef(section));
+            }
+
+            bool on_field(const char* data, const Document::Span& field, const Document::Span& value)
+            {
+                return handler.on_field(StringRef(section), StringRef(data + field.pos, field.len), StringRef(data + value.pos, value.len));
+            }
+
+            bool on_comment(const char* data, const Document::Span& line)
+            {
+                return handler.on_comment(StringRef(data + line.pos, line.len));
+            }
+        };
+
+        const ParseRules rules = parse_rules();
+        Dispatcher dispatcher = { handler, std::string() };
+        std::vector<char> chunk(std::max<std::size_t>(chunk_size, 1));
+        std::size_t filled = 0;
+        bool has_section = false;
+        while (true)
+        {
+            const std::size_t request = chunk.size() - filled;
+            const std::size_t read = file.read(chunk.data() + filled, request);
+            filled += read;
+            record(Instrumentation::BYTES_READ, static_cast<std::uint64_t>(read));
+            const bool last = read < request;
+            if (file.failed())
+                return false;
+
+            std::size_t consumed;
+            const bool proceed = scan_lines(rules, chunk.data(), filled, last, has_section, dispatcher, consumed);
+            record_lines(chunk.data(), chunk.data() + consumed);
+            if (!proceed || last)
+                return true;
+
+            if (consumed == 0)
+            {
+                // 1行が読込単位より長い場合は、その行が収まるまで読込領域を拡張する。
+                chunk.resize(chunk.size() * 2);
+                continue;
+            }
+            std::memmove(chunk.data(), chunk.data() + consumed, filled - consumed);
+            filled -= consumed;
+        }
+    }
+
+private:
+
+#if INI_HAS_MEMORY_RESOURCE
+    typedef std::pmr::memory_resource MemoryResource;
+#else
+    struct MemoryResource;
+#endif
+
+    /**
+     * @class Arena
+     * @brief ドキュメントの文字列・配列を連続した大きな領域から切り出して確保する単調増加型のアロケータ
+     * @note 個々の領域は解放せず、Arenaの破棄時にまとめて解放する。
+     *       読込1回あたりの確保回数をフィールド数によらず数回に抑える。
+     */
+    class Arena
+    {
+    public:
+        explicit Arena(MemoryResource* upstream)
+         :  upstream_(upstream), head_(nullptr), cursor_(nullptr), end_(nullptr), next_size_(4096)
+        {}
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        ~Arena()
+        {
+            while (head_ != nullptr)
+            {
+                Block* next = head_->next;
+                release(head_, head_->size);
+                head_ = next;
+            }
+        }
+
+        void* allocate(const std::size_t size, const std::size_t alignment)
+        {
+            std::size_t offset = static_cast<std::size_t>(-reinterpret_cast<std::uintptr_t>(cursor_)) & (alignment - 1);
+            if (cursor_ == nullptr || static_cast<std::size_t>(end_ - cursor_) < offset + size)
+            {
+                grow(size + alignment);
+                offset = static_cast<std::size_t>(-reinterpret_cast<std::uintptr_t>(cursor_)) & (alignment - 1);
+            }
+            char* ptr = cursor_ + offset;
+            cursor_ = ptr + size;
+            return ptr;
+        }
+
+        MemoryResource* upstream() const { return upstream_; }
+
+    private:
+        struct Block
+        {
+            Block* next;
+            std::size_t size;
+        };
+
+        MemoryResource* upstream_;
+        Block* head_;
+        char* cursor_;
+        char* end_;
+        std::size_t next_size_;
+
+        void grow(const std::size_t minimum)
+        {
+            const std::size_t header = (sizeof(Block) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+            const std::size_t size = std::max<std::size_t>(next_size_, minimum + header);
+            next_size_ = std::min<std::size_t>(next_size_ << 1, 1u << 20);
+
+            Block* block = static_cast<Block*>(acquire(size));
+            block->next = head_;
+            block->size = size;
+            head_ = block;
+            cursor_ = reinterpret_cast<char*>(block) + header;
+            end_ = reinterpret_cast<char*>(block) + size;
+        }
+
+        void* acquire(const std::size_t size)
+        {
+#if INI_HAS_MEMORY_RESOURCE
+            if (upstream_ != nullptr)
+                return upstream_->allocate(size, alignof(std::max_align_t));
+#endif
+            return ::operator new(size);
+        }
+
+        void release(void* ptr, const std::size_t size)
+        {
+#if INI_HAS_MEMORY_RESOURCE
+            if (upstream_ != nullptr)
+            {
+                upstream_->deallocate(ptr, size, alignof(std::max_align_t));
+                return;
+            }
+#endif
+            (void)size;
+            ::operator delete(ptr);
+        }
+    };
+
+    /**
+     * @class ArenaAllocator
+     * @brief @ref Arena から領域を確保する標準コンテナ用のアロケータ
+     */
+    template <class T>
+    class ArenaAllocator
+    {
+    public:
+        typedef T value_type;
+
+        explicit ArenaAllocator(Arena& arena) : arena_(&arena) {}
+        template <class U> ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena_) {}
+
+        T* allocate(const std::size_t n) { return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T))); }
+        void deallocate(T*, std::size_t) {}
+
+        template <class U> bool operator==(const ArenaAllocator<U>& other) const { return arena_ == other.arena_; }
+        template <class U> bool operator!=(const ArenaAllocator<U>& other) const { return arena_ != other.arena_; }
+
+    private:
+        template <class U> friend class ArenaAllocator;
+        Arena* arena_;
+    };
+
+    /**
+     * @fn make_node
+     * @brief 指定のメモリリソースから領域を確保してドキュメント等を生成するメソッド
+     */
+    template <class T>
+    static std::shared_ptr<T> make_node(MemoryResource* memory_resource)
+    {
+#if INI_HAS_MEMORY_RESOURCE
+        if (memory_resource != nullptr)
+            return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(memory_resource), memory_resource);
+#endif
+        return std::make_shared<T>(memory_resource);
+    }
+
+    /**
+     * @struct Scanner
+     * @brief 行末・区切り文字の検索をベクトル命令(AVX2/SSE2/NEON)で行う走査関数群
+     * @note 16/32バイト単位で比較し、対応する命令が無い環境ではスカラ実装で走査する。
+     */
+    struct Scanner
+    {
+#if defined(INI_SIMD_AVX2)
+        static const std::size_t width = 32;
+#elif defined(INI_SIMD_SSE2) || defined(INI_SIMD_NEON)
+        static const std::size_t width = 16;
+#else
+        static const std::size_t width = 1;
+#endif
+
+        static unsigned int first_bit(const std::uint64_t mask)
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward64(&index, mask);
+            return static_cast<unsigned int>(index);
+#else
+            return static_cast<unsigned int>(__builtin_ctzll(mask));
+#endif
+        }
+
+        /**
+         * @fn match
+         * @brief firstから width バイトのうち、aもしくはbに一致するバイトのビットマスクの取得メソッド
+         * @note NEONでは1バイトあたり4ビットのマスクとなるため、位置は @ref position で求める。
+         */
+        static std::uint64_t match(const char* first, const char a, const char b)
+        {
+#if defined(INI_SIMD_AVX2)
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            const __m256i eq = _mm256_or_si256(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(a)), _mm256_cmpeq_epi8(block, _mm256_set1_epi8(b)));
+            return static_cast<std::uint32_t>(_mm256_movemask_epi8(eq));
+#elif defined(INI_SIMD_SSE2)
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            const __m128i eq = _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(a)), _mm_cmpeq_epi8(block, _mm_set1_epi8(b)));
+            return static_cast<std::uint32_t>(_mm_movemask_epi8(eq));
+#elif defined(INI_SIMD_NEON)
+            const uint8x16_t block = vld1q_u8(reinterpret_cast<const std::uint8_t*>(first));
+            const uint8x16_t eq = vorrq_u8(vceqq_u8(block, vdupq_n_u8(static_cast<std::uint8_t>(a))), vceqq_u8(block, vdupq_n_u8(static_cast<std::uint8_t>(b))));
+            return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+#else
+            return (*first == a || *first == b) ? 1 : 0;
+#endif
+        }
+
+        static std::size_t position(const std::uint64_t mask)
+        {
+#if defined(INI_SIMD_NEON)
+            return first_bit(mask) >> 2;
+#else
+            return first_bit(mask);
+#endif
+        }
+
+        /**
+         * @fn find_either
+         * @brief [first, last) で最初にaもしくはbが現れる位置の検索メソッド
+         * @return const char* 見つかった位置、見つからない場合はlast
+         */
+        static const char* find_either(const char* first, const char* last, const char a, const char b)
+        {
+            for (; static_cast<std::size_t>(last - first) >= width; first += width)
+            {
+                const std::uint64_t mask = match(first, a, b);
+                if (mask != 0)
+                    return first + position(mask);
+            }
+            for (; first != last; ++first)
+            {
+                if (*first == a || *first == b)
+                    return first;
+            }
+            return last;
+        }
+
+        static const char* find(const char* first, const char* last, const char c)
+        {
+            return find_either(first, last, c, c);
+        }
+
+        /**
+         * @fn find_line
+         * @brief 1回の走査で行末と行内最初の区切り文字を検索するメソッド
+         * @param const char* separator 見つかった区切り文字の位置(行内に無い場合はnullptr)
+         * @return const char* 行末('\n')の位置、見つからない場合はlast
+         */
+        static const char* find_line(const char* first, const char* last, const char field_separator, const char*& separator)
+        {
+            separator = nullptr;
+            const char* found = find_either(first, last, '\n', field_separator);
+            if (found == last || *found == '\n')
+                return found;
+            separator = found;
+            return find(found + 1, last, '\n');
+        }
+
+        /**
+         * @fn count
+         * @brief [first, last) に含まれる文字cの個数の取得メソッド
+         */
+        static std::size_t count(const char* first, const char* last, const char c)
+        {
+            std::size_t result = 0;
+#if defined(INI_SIMD_AVX2) || defined(INI_SIMD_SSE2) || defined(INI_SIMD_NEON)
+            // 8ビットの一致数を最大255ブロック分蓄積してから合算する。
+            while (static_cast<std::size_t>(last - first) >= width)
+            {
+                const std::size_t blocks = std::min<std::size_t>(static_cast<std::size_t>(last - first) / width, 255);
+#if defined(INI_SIMD_AVX2)
+                const __m256i target = _mm256_set1_epi8(c);
+                __m256i sum = _mm256_setzero_si256();
+                for (std::size_t i = 0; i < blocks; ++i, first += width)
+                    sum = _mm256_sub_epi8(sum, _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(first)), target));
+                const __m256i total = _mm256_sad_epu8(sum, _mm256_setzero_si256());
+                result += static_cast<std::size_t>(_mm256_extract_epi64(total, 0) + _mm256_extract_epi64(total, 1)
+                                                 + _mm256_extract_epi64(total, 2) + _mm256_extract_epi64(total, 3));
+#elif defined(INI_SIMD_SSE2)
+                const __m128i target = _mm_set1_epi8(c);
+                __m128i sum = _mm_setzero_si128();
+                for (std::size_t i = 0; i < blocks; ++i, first += width)
+                    sum = _mm_sub_epi8(sum, _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first)), target));
+                const __m128i total = _mm_sad_epu8(sum, _mm_setzero_si128());
+                result += static_cast<std::size_t>(_mm_cvtsi128_si32(total)) + static_cast<std::size_t>(_mm_extract_epi16(total, 4));
+#else
+                const uint8x16_t target = vdupq_n_u8(static_cast<std::uint8_t>(c));
+                uint8x16_t sum = vdupq_n_u8(0);
+                for (std::size_t i = 0; i < blocks; ++i, first += width)
+                    sum = vsubq_u8(sum, vceqq_u8(vld1q_u8(reinterpret_cast<const std::uint8_t*>(first)), target));
+                result += vaddlvq_u8(sum);
+#endif
+            }
+#endif
+            for (; first != last; ++first)
+                result += (*first == c) ? 1 : 0;
+            return result;
+        }
+    };
+
+    /**
+     * @struct FileStamp
+     * @brief ファイルの変更検知に用いる更新日時とサイズ
+     */
+    struct FileStamp
+    {
+        bool exists;
+        long long size;
+        long long modified;
+
+        bool operator==(const FileStamp& other) const
+        {
+            return exists == other.exists && size == other.size && modified == other.modified;
+        }
+
+        static FileStamp of(const std::string& file_path)
+        {
+            FileStamp stamp = { false, 0, 0 };
+#if defined(_WIN32)
+            WIN32_FILE_ATTRIBUTE_DATA data;
+            if (GetFileAttributesExA(file_path.c_str(), GetFileExInfoStandard, &data))
+            {
+                stamp.exists = true;
+                stamp.size = (static_cast<long long>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+                stamp.modified = (static_cast<long long>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+            }
+#else
+            struct stat st;
+            if (::stat(file_path.c_str(), &st) == 0)
+            {
+                stamp.exists = true;
+                stamp.size = static_cast<long long>(st.st_size);
+#if defined(__APPLE__)
+                stamp.modified = static_cast<long long>(st.st_mtimespec.tv_sec) * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+                stamp.modified = static_cast<long long>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+            }
+#endif
+            return stamp;
+        }
+    };
+
+    /**
+     * @class Buffer
+     * @brief @ref load により読み込んだファイル内容の保持クラス
+     * @note ファイル内容を @ref Arena 上の連続領域に複製して保持するか、メモリマップした領域をそのまま保持する。
+     */
+    class Buffer
+    {
+    public:
+        FileStamp stamp;
+        bool unsaved;               ///< 遅延書込によりstamp時点のファイル内容から変更されている場合はtrue
+        std::uint64_t generation;   ///< 共有メモリから参照した場合の公開世代
+
+        explicit Buffer(MemoryResource* memory_resource)
+         :  stamp(), unsaved(false), generation(0), arena_(memory_resource), data_(""), size_(0), mapped_(nullptr), mapped_size_(0)
+#if defined(_WIN32)
+          , file_(INVALID_HANDLE_VALUE), mapping_(nullptr)
+#endif
+        {}
+
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+
+        ~Buffer()
+        {
+            unmap();
+        }
+
+        const char* data() const { return data_; }
+        std::size_t size() const { return size_; }
+        bool is_mapped() const { return mapped_ != nullptr; }
+
+        /**
+         * @fn allocate
+         * @brief ファイル内容を複製する領域の確保メソッド
+         */
+        char* allocate(const std::size_t size)
+        {
+            char* data = static_cast<char*>(arena_.allocate(size, 1));
+            data_ = data;
+            size_ = size;
+            return data;
+        }
+
+        void shrink(const std::size_t size)
+        {
+            size_ = size;
+        }
+
+        bool map(const std::string& file_path)
+        {
+#if defined(_WIN32)
+            file_ = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file_ == INVALID_HANDLE_VALUE)
+                return false;
+
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(file_, &size))
+                return false;
+            if (size.QuadPart == 0)
+                return true;
+
+            mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping_ == nullptr)
+                return false;
+            mapped_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+            if (mapped_ == nullptr)
+                return false;
+            mapped_size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+            int fd = ::open(file_path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return false;
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0)
+            {
+                ::close(fd);
+                return false;
+            }
+            if (st.st_size == 0)
+            {
+                ::close(fd);
+                return true;
+            }
+
+            void* mapped = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (mapped == MAP_FAILED)
+                return false;
+            mapped_ = mapped;
+            mapped_size_ = static_cast<std::size_t>(st.st_size);
+#endif
+            data_ = static_cast<const char*>(mapped_);
+            size_ = mapped_size_;
+            return true;
+        }
+
+        /**
+         * @fn map_shared
+         * @brief 名前付きの共有メモリを読取専用でマップするメソッド
+         * @note Windowsでは領域の大きさをページ単位で扱うため、末尾に未使用の領域を含むことがある。
+         */
+        bool map_shared(const std::string& name)
+        {
+#if defined(_WIN32)
+            mapping_ = OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str());
+            if (mapping_ == nullptr)
+                return false;
+            mapped_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+            if (mapped_ == nullptr)
+                return false;
+            MEMORY_BASIC_INFORMATION info;
+            if (VirtualQuery(mapped_, &info, sizeof(info)) == 0)
+                return false;
+            mapped_size_ = static_cast<std::size_t>(info.RegionSize);
+#else
+            int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+            if (fd < 0)
+                return false;
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || st.st_size == 0)
+            {
+                ::close(fd);
+                return false;
+            }
+
+            void* mapped = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (mapped == MAP_FAILED)
+                return false;
+            mapped_ = mapped;
+            mapped_size_ = static_cast<std::size_t>(st.st_size);
+#endif
+            data_ = static_cast<const char*>(mapped_);
+            size_ = mapped_size_;
+            return true;
+        }
+
+    private:
+        Arena arena_;
+        const char* data_;
+        std::size_t size_;
+        void* mapped_;
+        std::size_t mapped_size_;
+#if defined(_WIN32)
+        HANDLE file_;
+        HANDLE mapping_;
+#endif
+
+        void unmap()
+        {
+#if defined(_WIN32)
+            if (mapped_ != nullptr)
+                UnmapViewOfFile(mapped_);
+            if (mapping_ != nullptr)
+                CloseHandle(mapping_);
+            if (file_ != INVALID_HANDLE_VALUE)
+                CloseHandle(file_);
+            mapping_ = nullptr;
+            file_ = INVALID_HANDLE_VALUE;
+#else
+            if (mapped_ != nullptr)
+                ::munmap(mapped_, mapped_size_);
+#endif
+            mapped_ = nullptr;
+            mapped_size_ = 0;
+        }
+    };
+
+
+    /**
+     * @class InputFile
+     * @brief iniファイルを先頭から順に読み込むクラス
+     * @note INI_WITH_ZLIB を定義した場合、gzip形式のファイルは先頭の識別子により判定し、展開しながら読み込む。
+     *       展開した内容の全体を保持せず、読み込んだ分のみを呼出し側の領域へ展開する。
+     */
+    class InputFile
+    {
+    public:
+        InputFile() : size_hint_(0), failed_(false)
+#if defined(INI_WITH_ZLIB)
+          , gz_(nullptr)
+#endif
+        {}
+
+        InputFile(const InputFile&) = delete;
+        InputFile& operator=(const InputFile&) = delete;
+
+        ~InputFile()
+        {
+#if defined(INI_WITH_ZLIB)
+            if (gz_ != nullptr)
+                gzclose(gz_);
+#endif
+        }
+
+        bool open(const std::string& file_path)
+        {
+            ifs_.open(file_path, std::ios::binary);
+            if (!ifs_.is_open())
+                return false;
+            ifs_.seekg(0, std::ios::end);
+            const std::streamoff size = ifs_.tellg();
+            ifs_.seekg(0, std::ios::beg);
+            size_hint_ = (size > 0) ? static_cast<std::size_t>(size) : 0;
+#if defined(INI_WITH_ZLIB)
+            unsigned char magic[2] = { 0, 0 };
+            ifs_.read(reinterpret_cast<char*>(magic), sizeof(magic));
+            if (ifs_.gcount() == 2 && is_gzip(reinterpret_cast<const char*>(magic), 2))
+            {
+                // 展開後の大きさは末尾に4GiBの剰余として記録されているため、領域の確保量の目安とする。
+                // 破損したファイルの値で過大な領域を確保しないよう、圧縮後の大きさの一定倍までに制限する。
+                unsigned char trailer[4] = { 0, 0, 0, 0 };
+                ifs_.seekg(-4, std::ios::end);
+                ifs_.read(reinterpret_cast<char*>(trailer), sizeof(trailer));
+                const std::size_t trailer_size = static_cast<std::size_t>(trailer[0]) | (static_cast<std::size_t>(trailer[1]) << 8)
+                                               | (static_cast<std::size_t>(trailer[2]) << 16) | (static_cast<std::size_t>(trailer[3]) << 24);
+                size_hint_ = std::min(trailer_size, size_hint_ * 16);
+                ifs_.close();
+                gz_ = gzopen(file_path.c_str(), "rb");
+                if (gz_ == nullptr)
+                    return false;
+                gzbuffer(gz_, 128 * 1024);
+                return true;
+            }
+            ifs_.clear();
+            ifs_.seekg(0, std::ios::beg);
+#endif
+            return true;
+        }
+
+        /**
+         * @fn read
+         * @brief 最大sizeバイトの読込メソッド
+         * @return std::size_t 読み込んだバイト数。ファイル末尾に達した場合のみsizeより小さくなる。
+         *         読込に失敗した場合(途中で途切れたgzip形式のファイルを含む)は @ref failed がtrueとなる。
+         */
+        std::size_t read(char* data, const std::size_t size)
+        {
+#if defined(INI_WITH_ZLIB)
+            if (gz_ != nullptr)
+            {
+                std::size_t total = 0;
+                while (total < size)
+                {
+                    const unsigned int request = static_cast<unsigned int>(std::min<std::size_t>(size - total, 1u << 30));
+                    const int result = gzread(gz_, data + total, request);
+                    if (result < 0)
+                    {
+                        failed_ = true;
+                        break;
+                    }
+                    total += static_cast<std::size_t>(result);
+                    if (static_cast<unsigned int>(result) < request)
+                    {
+                        // 途中で途切れたファイルも短い読込となるため、正常な終端に達したかを確認する。
+                        int error = Z_OK;
+                        gzerror(gz_, &error);
+                        if (error != Z_OK)
+                            failed_ = true;
+                        break;
+                    }
+                }
+                return total;
+            }
+#endif
+            ifs_.read(data, static_cast<std::streamsize>(size));
+            if (!ifs_ && !ifs_.eof())
+                failed_ = true;
+            return static_cast<std::size_t>(ifs_.gcount());
+        }
+
+        /// 展開後の大きさの目安 (圧縮していない場合はファイルの大きさ)
+        std::size_t size_hint() const { return size_hint_; }
+
+        bool compressed() const
+        {
+#if defined(INI_WITH_ZLIB)
+            return gz_ != nullptr;
+#else
+            return false;
+#endif
+        }
+
+        bool failed() const { return failed_; }
+
+    private:
+        std::ifstream ifs_;
+        std::size_t size_hint_;
+        bool failed_;
+#if defined(INI_WITH_ZLIB)
+        gzFile gz_;
+#endif
+    };
+
+    static bool is_gzip(const char* data, const std::size_t size)
+    {
+        return size >= 2 && static_cast<unsigned char>(data[0]) == 0x1f && static_cast<unsigned char>(data[1]) == 0x8b;
+    }
+
+    /**
+     * @fn is_compressed_input
+     * @brief ファイルを展開して読み込むかどうかの判定メソッド
+     * @return bool INI_WITH_ZLIB を定義し、ファイルがgzip形式の場合はtrueを返却する。
+     */
+    static bool is_compressed_input(const std::string& file_path)
+    {
+#if defined(INI_WITH_ZLIB)
+        std::ifstream ifs(file_path, std::ios::binary);
+        char magic[2];
+        return ifs.read(magic, sizeof(magic)) && is_gzip(magic, sizeof(magic));
+#else
+        (void)file_path;
+        return false;
+#endif
+    }
+
+    /**
+     * @fn is_compressed_output
+     * @brief ファイルへ圧縮して書き込むかどうかの判定メソッド
+     * @return bool INI_WITH_ZLIB を定義し、ファイル名の拡張子が".gz"の場合はtrueを返却する。
+     */
+    static bool is_compressed_output(const std::string& file_path)
+    {
+#if defined(INI_WITH_ZLIB)
+        return file_path.size() > 3 && file_path.compare(file_path.size() - 3, 3, ".gz") == 0;
+#else
+        (void)file_path;
+        return false;
+#endif
+    }
+
+#if defined(INI_WITH_ZLIB)
+    /**
+     * @fn compress
+     * @brief 内容をgzip形式へ圧縮するメソッド
+     */
+    static bool compress(const std::string& content, std::string& compressed)
+    {
+        z_stream stream;
+        std::memset(&stream, 0, sizeof(stream));
+        // windowBitsへ16を加えるとgzip形式のヘッダとトレーラを付加する。
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            return false;
+        compressed.resize(deflateBound(&stream, static_cast<uLong>(content.size())));
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(content.data()));
+        stream.avail_in = static_cast<uInt>(content.size());
+        stream.next_out = reinterpret_cast<Bytef*>(&compressed[0]);
+        stream.avail_out = static_cast<uInt>(compressed.size());
+        const int result = deflate(&stream, Z_FINISH);
+        compressed.resize(stream.total_out);
+        deflateEnd(&stream);
+        return result == Z_STREAM_END;
+    }
+#endif
+    /**
+     * @class SymbolTable
+     * @brief セクション名・フィールド名へ識別番号を割り当てる表
+     * @note 名前は一度だけ複製して保持し、割り当てた番号は表を破棄するまで変わらない。
+     *       複数スレッドから同時に呼び出してもよい。
+     */
+    class SymbolTable
+    {
+    public:
+        std::uint32_t intern(const StringRef& name)
+        {
+            const std::uint64_t hash = hash_bytes(name.data(), name.size(), 0xcbf29ce484222325ULL);
+            std::lock_guard<std::mutex> lock(mutex_);
+            return intern(name, hash);
+        }
+
+        /**
+         * @fn intern
+         * @brief 複数の名前へまとめて識別番号を割り当てるメソッド
+         * @note 排他は一度のみ行う。ids[i]には names[i] の識別番号を格納する。
+         */
+        void intern(const std::vector<StringRef>& names, std::vector<std::uint32_t>& ids)
+        {
+            ids.resize(names.size());
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (std::size_t i = 0; i < names.size(); ++i)
+                ids[i] = intern(names[i], hash_bytes(names[i].data(), names[i].size(), 0xcbf29ce484222325ULL));
+        }
+
+        StringRef name(const std::uint32_t id) const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (id == 0 || id > names_.size())
+                return StringRef("", 0);
+            return StringRef(names_[id - 1]);
+        }
+
+    private:
+        mutable std::mutex mutex_;
+        std::deque<std::string> names_;    ///< 追加によって既存の要素が移動しないため、名前の参照を返却できる。
+        std::unordered_multimap<std::uint64_t, std::uint32_t> by_hash_;
+
+        std::uint32_t intern(const StringRef& name, const std::uint64_t hash)
+        {
+            auto range = by_hash_.equal_range(hash);
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                if (name.equals(names_[it->second - 1]))
+                    return it->second;
+            }
+            names_.emplace_back(name.data(), name.size());
+            const std::uint32_t id = static_cast<std::uint32_t>(names_.size());
+            by_hash_.emplace(hash, id);
+            return id;
+        }
+    };
+
+    /**
+     * @class SharedSegment
+     * @brief 名前付きの共有メモリを作成し、書込可能な状態でマップするクラス
+     * @note POSIXでは破棄後も共有メモリは残り、名前を削除するまで他プロセスから参照できる。
+     *       Windowsでは全てのプロセスがハンドルを閉じた時点で削除される。
+     */
+    class SharedSegment
+    {
+    public:
+        SharedSegment()
+         :  data_(nullptr), size_(0)
+#if defined(_WIN32)
+          , mapping_(nullptr)
+#endif
+        {}
+
+        SharedSegment(const SharedSegment&) = delete;
+        SharedSegment& operator=(const SharedSegment&) = delete;
+
+        ~SharedSegment()
+        {
+#if defined(_WIN32)
+            if (data_ != nullptr)
+                UnmapViewOfFile(data_);
+            if (mapping_ != nullptr)
+                CloseHandle(mapping_);
+#else
+            if (data_ != nullptr)
+                ::munmap(data_, size_);
+#endif
+        }
+
+        char* data() const { return data_; }
+
+        /**
+         * @fn create
+         * @brief 共有メモリを作成(既に存在する場合は開いて)マップするメソッド
+         * @param std::size_t size マップする大きさ(既存の共有メモリがこれより小さい場合は拡張する)
+         */
+        bool create(const std::string& name, const std::size_t size)
+        {
+#if defined(_WIN32)
+            const std::uint64_t size64 = size;
+            mapping_ = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32),
+                                          static_cast<DWORD>(size64 & 0xffffffffu), name.c_str());
+            if (mapping_ == nullptr)
+                return false;
+            data_ = static_cast<char*>(MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, size));
+            if (data_ == nullptr)
+                return false;
+#else
+            int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT, 0644);
+            if (fd < 0)
+                return false;
+
+            struct stat st;
+            bool result = ::fstat(fd, &st) == 0;
+            if (result && static_cast<std::size_t>(st.st_size) < size)
+                result = ::ftruncate(fd, static_cast<off_t>(size)) == 0;
+            void* mapped = result ? ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+            ::close(fd);
+            if (mapped == MAP_FAILED)
+                return false;
+            data_ = static_cast<char*>(mapped);
+#endif
+            size_ = size;
+            return true;
+        }
+
+        static void remove(const std::string& name)
+        {
+#if defined(_WIN32)
+            (void)name;
+#else
+            ::shm_unlink(name.c_str());
+#endif
+        }
+
+    private:
+        char* data_;
+        std::size_t size_;
+#if defined(_WIN32)
+        HANDLE mapping_;
+#endif
+    };
+
+    /**
+     * @struct SharedControl
+     * @brief @ref publish で作成する共有メモリの管理領域
+     * @note 公開したドキュメントは名前に"."と世代を付加した共有メモリに格納し、世代の更新により差替えを通知する。
+     */
+    struct SharedControl
+    {
+        char magic[8];
+        std::atomic<std::uint64_t> generation;
+    };
+
+    static const char* shared_magic() { return "INISHARE"; }
+
+    static std::string shared_image_name(const std::string& name, const std::uint64_t generation)
+    {
+        return name + "." + std::to_string(generation);
+    }
+
+    /**
+     * @struct ParseRules
+     * @brief ファイル内容の解析に用いる規則と通知先
+     * @note 遅延解析するドキュメントは解析規則を複製して保持し、読み込んだインスタンスの寿命によらず解析する。
+     */
+    struct ParseRules
+    {
+        char field_separator;
+        std::vector<std::string> comment_prefix_list;
+        unsigned int parallel_load;
+        MemoryResource* memory_resource;
+#if defined(INI_ENABLE_INSTRUMENTATION)
+        Instrumentation* instrumentation;
+#endif
+    };
+
+    /**
+     * @struct Document
+     * @brief @ref load により読み込んだファイル内容とフィールドの位置情報
+     * @note セクション名・フィールド名・値はファイル内容上の位置と長さで保持し、文字列の複製は行わない。
+     */
+    struct Document
+    {
+        struct Span
+        {
+            std::size_t pos;
+            std::size_t len;
+        };
+
+        struct Entry
+        {
+            Span section;
+            Span field;
+            Span value;
+            std::uint64_t hash;
+        };
+
+        /**
+         * @struct Section
+         * @brief セクション行毎のエントリの範囲
+         * @note エントリはファイル上の出現順に並ぶため、同じセクション行に属するエントリは entries 上で連続する。
+         */
+        struct Section
+        {
+            Span name;
+            std::uint64_t hash;     ///< セクション名のハッシュ値
+            std::uint32_t first;    ///< 先頭のエントリの entries 上の位置
+            std::uint32_t count;    ///< エントリ数
+            std::uint32_t next;     ///< 同名の次のセクション行の sections 上の位置+1 (0は該当なし)
+        };
+
+        /**
+         * @struct Table
+         * @brief 配列の参照
+         * @note 解析したドキュメントでは Arena 上の配列を、@ref load_image で読み込んだドキュメントでは
+         *       マップしたキャッシュファイル上の配列を参照する。
+         */
+        template <class T>
+        struct Table
+        {
+            const T* items;
+            std::size_t count;
+
+            const T* data() const { return items; }
+            std::size_t size() const { return count; }
+            const T* begin() const { return items; }
+            const T* end() const { return items + count; }
+            const T& operator[](const std::size_t i) const { return items[i]; }
+        };
+
+        /// entry_storage・slot_storage・section_storage の領域を確保する。メンバの中で最後に破棄されるよう先頭に宣言する。
+        Arena arena;
+        std::shared_ptr<const Buffer> buffer;
+        const char* data;
+        std::vector<Entry, ArenaAllocator<Entry>> entry_storage;
+        std::vector<std::uint32_t, ArenaAllocator<std::uint32_t>> slot_storage;
+        std::vector<Section, ArenaAllocator<Section>> section_storage;
+        std::vector<std::uint32_t, ArenaAllocator<std::uint32_t>> section_slot_storage;
+
+        /// フィールドの位置情報の配列 (ファイル上の出現順)
+        Table<Entry> entries;
+
+        /// entries へのインデックス+1 を格納するオープンアドレス法のハッシュ表 (0は空きを表す)
+        Table<std::uint32_t> slots;
+
+        /// セクション行毎のエントリの範囲の配列 (ファイル上の出現順)
+        Table<Section> sections;
+
+        /// セクション名毎に最初のセクション行の sections 上の位置+1 を格納するオープンアドレス法のハッシュ表 (0は空きを表す)
+        Table<std::uint32_t> section_slots;
+
+        /**
+         * @struct TypedValue
+         * @brief エントリ毎の型変換結果
+         * @note 変換の有無・成否は state のビットで表し、値を格納してから state を更新する。
+         *       複数スレッドが同時に同じ変換を行った場合も格納される値は同一となる。
+         */
+        struct TypedValue
+        {
+            static const std::uint32_t INT_CACHED    = 1u << 0;
+            static const std::uint32_t INT_VALID     = 1u << 1;
+            static const std::uint32_t DOUBLE_CACHED = 1u << 2;
+            static const std::uint32_t DOUBLE_VALID  = 1u << 3;
+            static const std::uint32_t BOOL_CACHED   = 1u << 4;
+            static const std::uint32_t BOOL_VALID    = 1u << 5;
+            static const std::uint32_t BOOL_TRUE     = 1u << 6;
+
+            std::atomic<std::uint32_t> state;
+            std::atomic<std::int32_t> int_value;
+            std::atomic<std::uint64_t> double_bits;
+
+            TypedValue() : state(0), int_value(0), double_bits(0) {}
+        };
+
+        /// 型変換結果の配列 (entries と同じ並び)。最初の型変換時に確保する。
+        mutable std::atomic<TypedValue*> typed_values;
+
+        /**
+         * @struct PackedValue
+         * @brief キャッシュファイルに格納する変換済みの値
+         * @note state のビットの意味は @ref TypedValue と同一とする。
+         */
+        struct PackedValue
+        {
+            std::uint32_t state;
+            std::int32_t int_value;
+            std::uint64_t double_bits;
+        };
+
+        /// キャッシュファイルから読み込んだ変換済みの値の配列 (entries と同じ並び)。解析したドキュメントではnullptr。
+        const PackedValue* packed_values;
+
+        /// キャッシュファイルから読み込んだドキュメントの場合はtrue。位置情報はファイル上の位置を表さない。
+        bool compiled;
+
+        /**
+         * @struct SymbolIndex
+         * @brief エントリ毎のセクション名・フィールド名の識別番号と、識別番号の組による索引
+         * @note 同一のセクション・フィールドが複数存在する場合は @ref find と同じく最初のものを登録する。
+         */
+        struct SymbolIndex
+        {
+            std::vector<std::uint32_t> sections;    ///< entries と同じ並び
+            std::vector<std::uint32_t> fields;      ///< entries と同じ並び
+            std::vector<std::uint32_t> slots;       ///< entries へのインデックス+1 (0は空きを表す)
+
+            static std::size_t mix(const std::uint32_t section, const std::uint32_t field)
+            {
+                const std::uint64_t key = (static_cast<std::uint64_t>(section) << 32) | field;
+                return static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ULL) >> 32);
+            }
+
+            const Entry* find(const Document& document, const std::uint32_t section, const std::uint32_t field) const
+            {
+                const std::size_t mask = slots.size() - 1;
+                std::size_t slot = mix(section, field) & mask;
+                while (slots[slot] != 0)
+                {
+                    const std::size_t index = slots[slot] - 1;
+                    if (sections[index] == section && fields[index] == field)
+                        return &document.entries[index];
+                    slot = (slot + 1) & mask;
+                }
+                return nullptr;
+            }
+        };
+
+        /// 識別番号による索引。識別番号を用いた最初の検索時に構築する。
+        mutable std::atomic<SymbolIndex*> symbol_table_index;
+
+        /**
+         * @struct LazyIndex
+         * @brief 遅延解析するドキュメントのセクション行の位置と、解析済みのセクション行
+         * @note @ref set_lazy_load を指定して読み込んだドキュメントは entries・slots・sections を持たず、
+         *       セクション行毎に最初の検索時に解析したドキュメントを parts に保持する。
+         */
+        struct LazyIndex
+        {
+            struct Header
+            {
+                Span name;
+                std::uint64_t hash;     ///< セクション名のハッシュ値
+                std::size_t begin;      ///< セクション行の次の行の先頭位置
+                std::size_t end;        ///< 次のセクション行の先頭位置 (最後のセクション行ではファイル末尾)
+                std::uint32_t next;     ///< 同名の次のセクション行の headers 上の位置+1 (0は該当なし)
+            };
+
+            /// セクション行の配列 (ファイル上の出現順)
+            std::vector<Header> headers;
+
+            /// セクション名毎に最初のセクション行の headers 上の位置+1 を格納するオープンアドレス法のハッシュ表 (0は空きを表す)
+            std::vector<std::uint32_t> slots;
+
+            /// セクション行毎の解析結果 (headers と同じ並び)
+            std::unique_ptr<std::atomic<const Document*>[]> parts;
+
+            /// 全体の解析結果。全体を参照する処理の初回の呼出し時に解析する。
+            std::atomic<const Document*> whole;
+
+            /// 読み込んだインスタンスの解析規則の複製
+            ParseRules rules;
+
+            LazyIndex() : whole(nullptr) {}
+
+            ~LazyIndex()
+            {
+                for (std::size_t i = 0; i < headers.size(); ++i)
+                    delete parts[i].load(std::memory_order_acquire);
+                delete whole.load(std::memory_order_acquire);
+            }
+        };
+
+        /// 遅延解析するドキュメントの場合のみ保持する。
+        std::unique_ptr<LazyIndex> lazy;
+
+        /// 生成毎に異なる通し番号。@ref Key が位置を解決したドキュメントの識別に用いる。
+        const std::uint64_t serial;
+
+        explicit Document(MemoryResource* memory_resource)
+         :  arena(memory_resource), data(""), entry_storage(ArenaAllocator<Entry>(arena)), slot_storage(ArenaAllocator<std::uint32_t>(arena)),
+            section_storage(ArenaAllocator<Section>(arena)), section_slot_storage(ArenaAllocator<std::uint32_t>(arena)),
+            entries(), slots(), sections(), section_slots(), typed_values(nullptr), packed_values(nullptr), compiled(false), symbol_table_index(nullptr), serial(next_serial())
+        {}
+
+        /**
+         * @fn attach
+         * @brief entry_storage・slot_storage・section_storage の内容を entries・slots・sections として参照させるメソッド
+         */
+        void attach()
+        {
+            entries.items = entry_storage.data();
+            entries.count = entry_storage.size();
+            slots.items = slot_storage.data();
+            slots.count = slot_storage.size();
+            sections.items = section_storage.data();
+            sections.count = section_storage.size();
+            section_slots.items = section_slot_storage.data();
+            section_slots.count = section_slot_storage.size();
+        }
+
+        /**
+         * @fn build_sections
+         * @brief entries からセクション行毎のエントリの範囲とその索引を求め、sections・section_slots として参照させるメソッド
+         * @note 同じセクション行に属するエントリはセクション名の位置が等しいため、セクション行の判別に文字列比較は行わない。
+         *       同名のセクション行は next により出現順に連結する。
+         */
+        void build_sections()
+        {
+            section_storage.clear();
+            std::size_t section_pos = static_cast<std::size_t>(-1);
+            for (std::size_t i = 0; i < entries.size(); ++i)
+            {
+                const Entry& entry = entries[i];
+                if (section_storage.empty() || entry.section.pos != section_pos)
+                {
+                    section_pos = entry.section.pos;
+                    Section section;
+                    section.name = entry.section;
+                    section.hash = hash_section(StringRef(data + entry.section.pos, entry.section.len));
+                    section.first = static_cast<std::uint32_t>(i);
+                    section.count = 0;
+                    section.next = 0;
+                    section_storage.push_back(section);
+                }
+                ++section_storage.back().count;
+            }
+
+            link_names(section_storage, section_slot_storage);
+            sections.items = section_storage.data();
+            sections.count = section_storage.size();
+            section_slots.items = section_slot_storage.data();
+            section_slots.count = section_slot_storage.size();
+        }
+
+        /**
+         * @fn find_section
+         * @brief 指定した名前の最初のセクション行の取得メソッド
+         * @return const Section* 該当するセクション行が無い場合はnullptr。同名の後続のセクション行は next で辿る。
+         */
+        const Section* find_section(const StringRef& name) const
+        {
+            return find_section(name, hash_section(name));
+        }
+
+        const Section* find_section(const StringRef& name, const std::uint64_t hash) const
+        {
+            const std::uint32_t index = find_name(sections, section_slots, name, hash);
+            return (index == 0) ? nullptr : &sections[index - 1];
+        }
+
+        /**
+         * @fn link_names
+         * @brief セクション行の配列から、セクション名毎に最初のセクション行を引く索引を構築するメソッド
+         * @note 同名のセクション行は各要素の next により出現順に連結する。
+         */
+        template <class Items, class Slots>
+        void link_names(Items& items, Slots& slots) const
+        {
+            std::size_t capacity = 8;
+            while (capacity < items.size() * 2)
+                capacity <<= 1;
+            slots.assign(capacity, 0);
+            // 同名のセクション行を連結するため、各セクション名の最後のセクション行の位置を保持する。
+            std::vector<std::uint32_t> tails(capacity, 0);
+            const std::size_t mask = capacity - 1;
+            for (std::size_t i = 0; i < items.size(); ++i)
+            {
+                const StringRef name(data + items[i].name.pos, items[i].name.len);
+                std::size_t slot = static_cast<std::size_t>(items[i].hash) & mask;
+                while (slots[slot] != 0)
+                {
+                    const auto& other = items[slots[slot] - 1];
+                    if (other.hash == items[i].hash && equals(other.name, name))
+                        break;
+                    slot = (slot + 1) & mask;
+                }
+                if (slots[slot] == 0)
+                    slots[slot] = static_cast<std::uint32_t>(i + 1);
+                else
+                    items[tails[slot] - 1].next = static_cast<std::uint32_t>(i + 1);
+                tails[slot] = static_cast<std::uint32_t>(i + 1);
+            }
+        }
+
+        /**
+         * @fn find_name
+         * @brief @ref link_names で構築した索引から、指定した名前の最初のセクション行の位置+1を取得するメソッド
+         */
+        template <class Items, class Slots>
+        std::uint32_t find_name(const Items& items, const Slots& slots, const StringRef& name, const std::uint64_t hash) const
+        {
+            const std::size_t mask = slots.size() - 1;
+            std::size_t slot = static_cast<std::size_t>(hash) & mask;
+            while (slots[slot] != 0)
+            {
+                const auto& item = items[slots[slot] - 1];
+                if (item.hash == hash && equals(item.name, name))
+                    return slots[slot];
+                slot = (slot + 1) & mask;
+            }
+            return 0;
+        }
+
+        /**
+         * @fn part
+         * @brief 遅延解析するドキュメントのセクション行の解析結果の取得メソッド
+         * @note 複数スレッドから同時に呼び出された場合は、先に登録された解析結果を用いて残りは破棄する。
+         */
+        const Document& part(const std::size_t index) const
+        {
+            const Document* parsed = lazy->parts[index].load(std::memory_order_acquire);
+            if (parsed != nullptr)
+                return *parsed;
+            Document* created = new Document(lazy->rules.memory_resource);
+            const LazyIndex::Header& header = lazy->headers[index];
+            parse_part(lazy->rules, *created, buffer, header.name, header.begin, header.end);
+            if (lazy->parts[index].compare_exchange_strong(parsed, created, std::memory_order_acq_rel, std::memory_order_acquire))
+                return *created;
+            delete created;
+            return *parsed;
+        }
+
+        /**
+         * @fn complete
+         * @brief 遅延解析するドキュメントの全体の解析結果の取得メソッド
+         * @note 複数スレッドから同時に呼び出された場合は、先に登録された解析結果を用いて残りは破棄する。
+         */
+        const Document& complete() const
+        {
+            const Document* parsed = lazy->whole.load(std::memory_order_acquire);
+            if (parsed != nullptr)
+                return *parsed;
+            Document* created = new Document(lazy->rules.memory_resource);
+            parse_into(lazy->rules, *created, buffer);
+            if (lazy->whole.compare_exchange_strong(parsed, created, std::memory_order_acq_rel, std::memory_order_acquire))
+                return *created;
+            delete created;
+            return *parsed;
+        }
+
+        /**
+         * @fn owner
+         * @brief 遅延解析するドキュメントの検索結果のエントリを保持するドキュメントの取得メソッド
+         */
+        const Document& owner(const Entry& entry) const
+        {
+            const Document* parsed = lazy->whole.load(std::memory_order_acquire);
+            if (parsed != nullptr && &entry >= parsed->entries.begin() && &entry < parsed->entries.end())
+                return *parsed;
+            // セクション行はファイル上の出現順に並ぶため、エントリの位置を含むセクション行を二分探索する。
+            auto it = std::upper_bound(lazy->headers.begin(), lazy->headers.end(), entry.field.pos,
+                                       [](const std::size_t pos, const LazyIndex::Header& header) { return pos < header.begin; });
+            return part(static_cast<std::size_t>(it - lazy->headers.begin()) - 1);
+        }
+
+        /**
+         * @fn find_lazy
+         * @brief 遅延解析するドキュメントの検索メソッド
+         * @note 同名のセクション行を出現順に解析・検索するため、最初に現れたフィールドを返却する点は全体を解析した場合と同一となる。
+         */
+        const Entry* find_lazy(const StringRef& section, const StringRef& field, const std::uint64_t hash) const
+        {
+            const Document* parsed = lazy->whole.load(std::memory_order_acquire);
+            if (parsed != nullptr)
+                return parsed->find(section, field, hash);
+            for (std::uint32_t index = find_name(lazy->headers, lazy->slots, section, hash_section(section)); index != 0;
+                 index = lazy->headers[index - 1].next)
+            {
+                const Entry* entry = part(index - 1).find(section, field, hash);
+                if (entry != nullptr)
+                    return entry;
+            }
+            return nullptr;
+        }
+
+        static std::uint64_t next_serial()
+        {
+            static std::atomic<std::uint64_t> counter(0);
+            return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
+        ~Document()
+        {
+            delete symbol_table_index.load(std::memory_order_acquire);
+            TypedValue* values = typed_values.load(std::memory_order_acquire);
+            if (values == nullptr)
+                return;
+#if INI_HAS_MEMORY_RESOURCE
+            if (arena.upstream() != nullptr)
+            {
+                arena.upstream()->deallocate(values, sizeof(TypedValue) * entries.size(), alignof(TypedValue));
+                return;
+            }
+#endif
+            ::operator delete(values);
+        }
+
+        /**
+         * @fn typed_value
+         * @brief エントリの型変換結果の取得メソッド
+         * @note 複数スレッドから同時に呼び出された場合は、先に登録された配列を用いて残りは破棄する。
+         */
+        TypedValue& typed_value(const Entry& entry) const
+        {
+            TypedValue* values = typed_values.load(std::memory_order_acquire);
+            if (values == nullptr)
+            {
+                const std::size_t size = sizeof(TypedValue) * entries.size();
+                void* storage;
+#if INI_HAS_MEMORY_RESOURCE
+                if (arena.upstream() != nullptr)
+                    storage = arena.upstream()->allocate(size, alignof(TypedValue));
+                else
+#endif
+                    storage = ::operator new(size);
+
+                TypedValue* created = static_cast<TypedValue*>(storage);
+                for (std::size_t i = 0; i < entries.size(); ++i)
+                    new (created + i) TypedValue();
+
+                if (typed_values.compare_exchange_strong(values, created, std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    values = created;
+                }
+                else
+                {
+#if INI_HAS_MEMORY_RESOURCE
+                    if (arena.upstream() != nullptr)
+                        arena.upstream()->deallocate(storage, size, alignof(TypedValue));
+                    else
+#endif
+                        ::operator delete(storage);
+                }
+            }
+            return values[&entry - entries.data()];
+        }
+
+        /**
+         * @fn symbol_index
+         * @brief 識別番号による索引の取得メソッド
+         * @note 全てのセクション名・フィールド名へ table の識別番号を割り当てて構築する。複数スレッドから同時に
+         *       呼び出された場合は、先に登録された索引を用いて残りは破棄する。
+         */
+        const SymbolIndex& symbol_index(SymbolTable& table) const
+        {
+            SymbolIndex* index = symbol_table_index.load(std::memory_order_acquire);
+            if (index != nullptr)
+                return *index;
+
+            // セクション名はセクション行毎に一度だけ割り当てる。
+            std::vector<StringRef> names;
+            std::vector<std::size_t> section_names(entries.size());
+            names.reserve(sections.size() + entries.size());
+            for (const auto& section : sections)
+            {
+                names.push_back(StringRef(data + section.name.pos, section.name.len));
+                std::fill(section_names.begin() + section.first, section_names.begin() + section.first + section.count, names.size() - 1);
+            }
+            const std::size_t field_offset = names.size();
+            for (const auto& entry : entries)
+                names.push_back(StringRef(data + entry.field.pos, entry.field.len));
+            std::vector<std::uint32_t> ids;
+            table.intern(names, ids);
+
+            SymbolIndex* created = new SymbolIndex();
+            created->sections.resize(entries.size());
+            created->fields.resize(entries.size());
+            std::size_t slot_count = 1;
+            while (slot_count < entries.size() * 2)
+                slot_count <<= 1;
+            created->slots.assign(slot_count, 0);
+            for (std::size_t i = 0; i < entries.size(); ++i)
+            {
+                const std::uint32_t section = ids[section_names[i]];
+                const std::uint32_t field = ids[field_offset + i];
+                created->sections[i] = section;
+                created->fields[i] = field;
+                if (created->find(*this, section, field) != nullptr)
+                    continue;
+                std::size_t slot = SymbolIndex::mix(section, field) & (slot_count - 1);
+                while (created->slots[slot] != 0)
+                    slot = (slot + 1) & (slot_count - 1);
+                created->slots[slot] = static_cast<std::uint32_t>(i + 1);
+            }
+
+            if (symbol_table_index.compare_exchange_strong(index, created, std::memory_order_acq_rel, std::memory_order_acquire))
+                return *created;
+            delete created;
+            return *index;
+        }
+
+        StringRef value_of(const Entry& entry) const
+        {
+            return StringRef(data + entry.value.pos, entry.value.len);
+        }
+
+        bool convert(const Entry& entry, int& value) const
+        {
+            if (lazy)
+                return owner(entry).convert(entry, value);
+            if (packed_values != nullptr)
+            {
+                const PackedValue& packed = packed_values[&entry - entries.data()];
+                if ((packed.state & TypedValue::INT_VALID) == 0)
+                    return false;
+                value = packed.int_value;
+                return true;
+            }
+
+            TypedValue& cache = typed_value(entry);
+            std::uint32_t state = cache.state.load(std::memory_order_acquire);
+            if ((state & TypedValue::INT_CACHED) == 0)
+            {
+                int converted = 0;
+                const std::uint32_t flags = TypedValue::INT_CACHED | (convert_int(value_of(entry), converted) ? TypedValue::INT_VALID : 0u);
+                cache.int_value.store(converted, std::memory_order_relaxed);
+                state = cache.state.fetch_or(flags, std::memory_order_release) | flags;
+            }
+            if ((state & TypedValue::INT_VALID) == 0)
+                return false;
+            value = cache.int_value.load(std::memory_order_relaxed);
+            return true;
+        }
+
+        bool convert(const Entry& entry, double& value) const
+        {
+            if (lazy)
+                return owner(entry).convert(entry, value);
+            if (packed_values != nullptr)
+            {
+                const PackedValue& packed = packed_values[&entry - entries.data()];
+                if ((packed.state & TypedValue::DOUBLE_VALID) == 0)
+                    return false;
+                std::memcpy(&value, &packed.double_bits, sizeof(value));
+                return true;
+            }
+
+            TypedValue& cache = typed_value(entry);
+            std::uint32_t state = cache.state.load(std::memory_order_acquire);
+            if ((state & TypedValue::DOUBLE_CACHED) == 0)
+            {
+                double converted = 0.0;
+                const std::uint32_t flags = TypedValue::DOUBLE_CACHED | (convert_double(value_of(entry), converted) ? TypedValue::DOUBLE_VALID : 0u);
+                std::uint64_t bits;
+                std::memcpy(&bits, &converted, sizeof(bits));
+                cache.double_bits.store(bits, std::memory_order_relaxed);
+                state = cache.state.fetch_or(flags, std::memory_order_release) | flags;
+            }
+            if ((state & TypedValue::DOUBLE_VALID) == 0)
+                return false;
+            const std::uint64_t bits = cache.double_bits.load(std::memory_order_relaxed);
+            std::memcpy(&value, &bits, sizeof(value));
+            return true;
+        }
+
+        bool convert(const Entry& entry, bool& value) const
+        {
+            if (lazy)
+                return owner(entry).convert(entry, value);
+            if (packed_values != nullptr)
+            {
+                const PackedValue& packed = packed_values[&entry - entries.data()];
+                if ((packed.state & TypedValue::BOOL_VALID) == 0)
+                    return false;
+                value = (packed.state & TypedValue::BOOL_TRUE) != 0;
+                return true;
+            }
+
+            TypedValue& cache = typed_value(entry);
+            std::uint32_t state = cache.state.load(std::memory_order_acquire);
+            if ((state & TypedValue::BOOL_CACHED) == 0)
+            {
+                bool converted = false;
+                const bool valid = convert_bool(value_of(entry), converted);
+                const std::uint32_t flags = TypedValue::BOOL_CACHED | (valid ? TypedValue::BOOL_VALID : 0u) | (converted ? TypedValue::BOOL_TRUE : 0u);
+                state = cache.state.fetch_or(flags, std::memory_order_release) | flags;
+            }
+            if ((state & TypedValue::BOOL_VALID) == 0)
+                return false;
+            value = (state & TypedValue::BOOL_TRUE) != 0;
+            return true;
+        }
+
+        bool convert(const Entry& entry, std::string& value) const
+        {
+            value.assign(data + entry.value.pos, entry.value.len);
+            return true;
+        }
+
+        bool equals(const Span& span, const StringRef& str) const
+        {
+            return str.equals(data + span.pos, span.len);
+        }
+
+        void build_index()
+        {
+            std::size_t capacity = 8;
+            while (capacity < entry_storage.size() * 2)
+                capacity <<= 1;
+            slot_storage.assign(capacity, 0);
+
+            const std::size_t mask = capacity - 1;
+            for (std::size_t i = 0; i < entry_storage.size(); ++i)
+            {
+                const Entry& entry = entry_storage[i];
+                std::size_t slot = static_cast<std::size_t>(entry.hash) & mask;
+                bool duplicated = false;
+                while (slot_storage[slot] != 0)
+                {
+                    const Entry& other = entry_storage[slot_storage[slot] - 1];
+                    if (other.hash == entry.hash
+                     && equals(entry.section, StringRef(data + other.section.pos, other.section.len))
+                     && equals(entry.field, StringRef(data + other.field.pos, other.field.len)))
+                    {
+                        // 同一のセクション・フィールドが複数存在する場合は先に現れたものを優先する。
+                        duplicated = true;
+                        break;
+                    }
+                    slot = (slot + 1) & mask;
+                }
+                if (!duplicated)
+                    slot_storage[slot] = static_cast<std::uint32_t>(i + 1);
+            }
+            attach();
+            build_sections();
+        }
+
+        const Entry* find(const StringRef& section, const StringRef& field) const
+        {
+            return find(section, field, hash_key(section, field));
+        }
+
+        const Entry* find(const StringRef& section, const StringRef& field, const std::uint64_t hash) const
+        {
+            if (lazy)
+                return find_lazy(section, field, hash);
+            const std::size_t mask = slots.size() - 1;
+            std::size_t slot = static_cast<std::size_t>(hash) & mask;
+            while (slots[slot] != 0)
+            {
+                const Entry& entry = entries[slots[slot] - 1];
+                if (entry.hash == hash && equals(entry.section, section) && equals(entry.field, field))
+                    return &entry;
+                slot = (slot + 1) & mask;
+            }
+            return nullptr;
+        }
+    };
+
+    /**
+     * @class Snapshot
+     * @brief 読込済みドキュメントをスレッド間で不可分に差し替えるための保持クラス
+     * @note 差替え後も参照中のスレッドが保持しているドキュメントは、その参照が無くなるまで解放されない。
+     */
+    class Snapshot
+    {
+    public:
+        Snapshot() : generation_(0) {}
+        Snapshot(const Snapshot& other) : document_(other.load()), generation_(0) {}
+
+        Snapshot& operator=(const Snapshot& other)
+        {
+            store(other.load());
+            return *this;
+        }
+
+        /**
+         * @fn generation
+         * @brief ドキュメントの差替え回数の取得メソッド
+         * @note 値が変化していなければ、以前に @ref load で取得したドキュメントが最新であることを示す。
+         */
+        std::uint64_t generation() const
+        {
+            return generation_.load(std::memory_order_acquire);
+        }
+
+        std::shared_ptr<const Document> load() const
+        {
+#if defined(__cpp_lib_atomic_shared_ptr)
+            return document_.load(std::memory_order_acquire);
+#else
+            return std::atomic_load(&document_);
+#endif
+        }
+
+        void store(std::shared_ptr<const Document> document)
+        {
+#if defined(__cpp_lib_atomic_shared_ptr)
+            document_.store(std::move(document), std::memory_order_release);
+#else
+            std::atomic_store(&document_, std::move(document));
+#endif
+            generation_.fetch_add(1, std::memory_order_release);
+        }
+
+    private:
+#if defined(__cpp_lib_atomic_shared_ptr)
+        std::atomic<std::shared_ptr<const Document>> document_;
+#else
+        std::shared_ptr<const Document> document_;
+#endif
+        std::atomic<std::uint64_t> generation_;
+    };
+
+    /**
+     * @class Mutex
+     * @brief 書込・再読込を直列化するための排他クラス
+     * @note インスタンスのコピー時には排他状態を共有せず、新たな排他を生成する。
+     */
+    class Mutex
+    {
+    public:
+        Mutex() {}
+        Mutex(const Mutex&) {}
+        Mutex& operator=(const Mutex&) { return *this; }
+
+        void lock() { mutex_.lock(); }
+        void unlock() { mutex_.unlock(); }
+
+    private:
+        std::mutex mutex_;
+    };
+
+    /**
+     * @class Flusher
+     * @brief 遅延書込の内容を一定周期で @ref flush する専用スレッドの管理クラス
+     * @note 初回の遅延書込時にスレッドを開始し、停止時は最後に一度 @ref flush してから終了する。
+     *       インスタンスのコピー時にはスレッドを共有せず、新たに生成する。
+     */
+    class Flusher
+    {
+    public:
+        Flusher() : interval_(0), stopping_(false), requested_(false) {}
+        Flusher(const Flusher&) : interval_(0), stopping_(false), requested_(false) {}
+        Flusher& operator=(const Flusher&) { return *this; }
+
+        ~Flusher()
+        {
+            stop();
+        }
+
+        void start(const Ini& ini, const std::chrono::milliseconds& interval)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (thread_.joinable() && interval_ == interval)
+                    return;
+                interval_ = interval;
+                if (!thread_.joinable())
+                    thread_ = std::thread(&Flusher::run, this, &ini);
+            }
+            condition_.notify_all();
+        }
+
+        void request()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                requested_ = true;
+            }
+            condition_.notify_all();
+        }
+
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            condition_.notify_all();
+            if (thread_.joinable())
+                thread_.join();
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = false;
+            requested_ = false;
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        std::chrono::milliseconds interval_;
+        bool stopping_;
+        bool requested_;
+        std::thread thread_;
+
+        void run(const Ini* ini)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!stopping_)
+            {
+                const std::chrono::milliseconds interval = interval_;
+                const bool woken = condition_.wait_for(lock, interval, [this, interval]{ return stopping_ || requested_ || interval_ != interval; });
+                // 周期のみが変更された場合は書き込まずに新たな周期で待機し直す。
+                if (woken && !stopping_ && !requested_)
+                    continue;
+                requested_ = false;
+                lock.unlock();
+                ini->flush();
+                lock.lock();
+            }
+            // 開始直後に停止を要求された場合も蓄積済みの書込を失わないよう、終了前に必ず書き込む。
+            lock.unlock();
+            ini->flush();
+        }
+    };
+
+    /**
+     * @class Executor
+     * @brief 非同期の読込・書込を登録順に実行する専用スレッドの管理クラス
+     * @note 初回の登録時にスレッドを開始し、破棄時は登録済みの処理を全て実行してから停止する。
+     *       インスタンスのコピー時にはスレッド・登録済みの処理を共有せず、新たに生成する。
+     */
+    class Executor
+    {
+    public:
+        Executor() : stopping_(false) {}
+        Executor(const Executor&) : stopping_(false) {}
+        Executor& operator=(const Executor&) { return *this; }
+
+        ~Executor()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            condition_.notify_all();
+            if (thread_.joinable())
+                thread_.join();
+        }
+
+        void post(std::function<void()> task)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                tasks_.push_back(std::move(task));
+                if (!thread_.joinable())
+                    thread_ = std::thread(&Executor::run, this);
+            }
+            condition_.notify_one();
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        std::deque<std::function<void()>> tasks_;
+        bool stopping_;
+        std::thread thread_;
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (true)
+            {
+                condition_.wait(lock, [this]{ return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty())
+                    return;
+                std::function<void()> task = std::move(tasks_.front());
+                tasks_.pop_front();
+                lock.unlock();
+                task();
+                lock.lock();
+            }
+        }
+    };
+
+    static std::uint64_t hash_bytes(const char* data, const std::size_t size, std::uint64_t hash)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    /**
+     * @fn hash_key
+     * @brief セクション名とフィールド名の組に対するハッシュ値(FNV-1a)の算出メソッド
+     * @note セクション名とフィールド名の境界を区別するため、間に区切りの1バイトを挟んで算出する。
+     */
+    static std::uint64_t hash_key(const StringRef& section, const StringRef& field)
+    {
+        std::uint64_t hash = hash_bytes("\xff", 1, hash_section(section));
+        return hash_bytes(field.data(), field.size(), hash);
+    }
+
+    static std::uint64_t hash_section(const StringRef& section)
+    {
+        return hash_bytes(section.data(), section.size(), 0xcbf29ce484222325ULL);
+    }
+
+    /**
+     * @fn hash_literal
+     * @brief ヌル終端文字列に対するFNV-1aのコンパイル時算出メソッド
+     * @note @ref hash_bytes と同一の値となる。
+     */
+    static constexpr std::uint64_t hash_literal(const char* str, const std::uint64_t hash)
+    {
+        return (*str == '\0') ? hash : hash_literal(str + 1, (hash ^ static_cast<unsigned char>(*str)) * 0x100000001b3ULL);
+    }
+
+    static constexpr std::size_t literal_size(const char* str)
+    {
+        return (*str == '\0') ? 0 : 1 + literal_size(str + 1);
+    }
+
+    template <class... Bindings>
+    struct BindingList
+    {
+        constexpr BindingList() {}
+    };
+
+    template <class Head, class... Tail>
+    struct BindingList<Head, Tail...>
+    {
+        Head head;
+        BindingList<Tail...> tail;
+
+        constexpr BindingList(const Head& head, const Tail&... tail)
+         :  head(head), tail(tail...)
+        {}
+    };
+
+    template <class Struct>
+    std::size_t read_bindings(const Document&, const BindingList<>&, Struct&) const
+    {
+        return 0;
+    }
+
+    template <class Struct, class Head, class... Tail>
+    std::size_t read_bindings(const Document& document, const BindingList<Head, Tail...>& bindings, Struct& object) const
+    {
+        const Head& binding = bindings.head;
+        const Document::Entry* entry = document.find(StringRef(binding.section, binding.section_size), StringRef(binding.field, binding.field_size), binding.hash);
+        std::size_t found = 0;
+        if (convert_entry(document, entry, object.*binding.member))
+            found = 1;
+        else
+            object.*binding.member = binding.default_value;
+        return found + read_bindings(document, bindings.tail, object);
+    }
+
+    template <class Struct>
+    static void assign_defaults(const BindingList<>&, Struct&)
+    {}
+
+    template <class Struct, class Head, class... Tail>
+    static void assign_defaults(const BindingList<Head, Tail...>& bindings, Struct& object)
+    {
+        object.*bindings.head.member = bindings.head.default_value;
+        assign_defaults(bindings.tail, object);
+    }
+
+    template <class Struct>
+    static void assign_line(const BindingList<>&, std::size_t, std::uint64_t, const StringRef&, const StringRef&, const StringRef&,
+                            Struct&, std::vector<bool>&, std::size_t&, std::size_t&)
+    {}
+
+    /**
+     * @fn assign_line
+     * @brief 読み込んだフィールド行に一致する対応付けへ値を格納するメソッド
+     * @note 同一のセクション・フィールドは最初に現れた行で値を確定し、以降の行は無視する。
+     */
+    template <class Struct, class Head, class... Tail>
+    static void assign_line(const BindingList<Head, Tail...>& bindings, const std::size_t index, const std::uint64_t hash,
+                            const StringRef& section_name, const StringRef& field_name, const StringRef& value,
+                            Struct& object, std::vector<bool>& seen, std::size_t& remaining, std::size_t& found)
+    {
+        const Head& binding = bindings.head;
+        if (!seen[index] && binding.hash == hash
+         && section_name.equals(binding.section, binding.section_size) && field_name.equals(binding.field, binding.field_size))
+        {
+            seen[index] = true;
+            --remaining;
+            typename std::remove_reference<decltype(object.*binding.member)>::type converted;
+            if (value.size() != 0 && convert_value(value, converted))
+            {
+                object.*binding.member = std::move(converted);
+                ++found;
+            }
+        }
+        assign_line(bindings.tail, index + 1, hash, section_name, field_name, value, object, seen, remaining, found);
+    }
+
+    std::string file_path_;
+    char field_separator_;
+    std::vector<std::string> comment_prefix_list_;
+    bool memory_map_;
+    unsigned int parallel_load_;
+    bool in_place_write_;
+    bool lazy_load_;
+    std::string cache_path_;
+    MemoryResource* memory_resource_;
+#if defined(INI_ENABLE_INSTRUMENTATION)
+    Instrumentation* instrumentation_;
+#endif
+    std::string shared_name_;
+    mutable std::shared_ptr<const Buffer> shared_control_;
+    std::string published_name_;
+    mutable std::shared_ptr<SharedSegment> published_control_;
+    mutable std::shared_ptr<SharedSegment> published_image_;
+    mutable Snapshot document_;
+    mutable Mutex write_mutex_;
+    std::chrono::milliseconds write_behind_interval_;
+    std::size_t write_behind_limit_;
+    mutable std::vector<FieldUpdate> dirty_;
+    mutable std::unordered_multimap<std::uint64_t, std::size_t> dirty_index_;
+    mutable std::size_t dirty_count_;
+    mutable Flusher flusher_;
+    std::shared_ptr<SymbolTable> symbols_;
+    // 登録済みの処理が他のメンバを参照するため、最初に破棄されるよう最後に宣言する。
+    mutable Executor executor_;
+
+    /**
+     * @fn record
+     * @brief 計数の通知メソッド
+     * @note INI_ENABLE_INSTRUMENTATION を定義しない場合は何も行わない。
+     */
+    void record(const Instrumentation::Counter counter, const std::uint64_t amount = 1) const
+    {
+#if defined(INI_ENABLE_INSTRUMENTATION)
+        if (instrumentation_ != nullptr && amount != 0)
+            instrumentation_->on_count(counter, amount);
+#else
+        (void)counter;
+        (void)amount;
+#endif
+    }
+
+    /**
+     * @fn record_lines
+     * @brief [first, last)に含まれる行数の通知メソッド
+     * @note 通知先を指定している場合のみ行数を数える。
+     */
+    void record_lines(const char* first, const char* last) const
+    {
+#if defined(INI_ENABLE_INSTRUMENTATION)
+        record_lines(instrumentation_, first, last);
+#else
+        (void)first;
+        (void)last;
+#endif
+    }
+
+    static void record_lines(const ParseRules& rules, const char* first, const char* last)
+    {
+#if defined(INI_ENABLE_INSTRUMENTATION)
+        record_lines(rules.instrumentation, first, last);
+#else
+        (void)rules;
+        (void)first;
+        (void)last;
+#endif
+    }
+
+#if defined(INI_ENABLE_INSTRUMENTATION)
+    static void record_lines(Instrumentation* instrumentation, const char* first, const char* last)
+    {
+        if (instrumentation != nullptr && first != last)
+            instrumentation->on_count(Instrumentation::LINES_SCANNED, Scanner::count(first, last, '\n') + (last[-1] != '\n' ? 1 : 0));
+    }
+#endif
+
+    /**
+     * @fn record_lookup
+     * @brief フィールド値の検索結果の通知メソッド
+     */
+    void record_lookup(const bool hit) const
+    {
+        record(Instrumentation::LOOKUPS);
+        record(hit ? Instrumentation::HITS : Instrumentation::MISSES);
+    }
+
+    /**
+     * @fn parse_rules
+     * @brief 現在の解析規則と通知先の取得メソッド
+     */
+    ParseRules parse_rules() const
+    {
+        ParseRules rules;
+        rules.field_separator = field_separator_;
+        rules.comment_prefix_list = comment_prefix_list_;
+        rules.parallel_load = parallel_load_;
+        rules.memory_resource = memory_resource_;
+#if defined(INI_ENABLE_INSTRUMENTATION)
+        rules.instrumentation = instrumentation_;
+#endif
+        return rules;
+    }
+
+    /**
+     * @class Stopwatch
+     * @brief 生成から破棄までの処理時間を通知するクラス
+     * @note INI_ENABLE_INSTRUMENTATION を定義しない場合、もしくは通知先を指定していない場合は時刻を取得しない。
+     */
+    class Stopwatch
+    {
+    public:
+#if defined(INI_ENABLE_INSTRUMENTATION)
+        Stopwatch(const Ini& ini, const Instrumentation::Timer timer)
+         :  instrumentation_(ini.instrumentation_), timer_(timer),
+            start_(instrumentation_ != nullptr ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+        {}
+
+        Stopwatch(const ParseRules& rules, const Instrumentation::Timer timer)
+         :  instrumentation_(rules.instrumentation), timer_(timer),
+            start_(instrumentation_ != nullptr ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+        {}
+
+        ~Stopwatch()
+        {
+            if (instrumentation_ != nullptr)
+                instrumentation_->on_latency(timer_, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_));
+        }
+
+    private:
+        Instrumentation* instrumentation_;
+        Instrumentation::Timer timer_;
+        std::chrono::steady_clock::time_point start_;
+#else
+        Stopwatch(const Ini& ini, const Instrumentation::Timer timer)
+        {
+            (void)ini;
+            (void)timer;
+        }
+
+        Stopwatch(const ParseRules& rules, const Instrumentation::Timer timer)
+        {
+            (void)rules;
+            (void)timer;
+        }
+#endif
+    };
+
+    /**
+     * @fn read_file
+     * @brief ファイル内容をbufferへ読み込むメソッド
+     * @note gzip形式のファイルは展開した内容を読み込む。展開後の大きさが末尾の記録と異なる場合
+     *       (4GiB以上、もしくは複数のメンバを連結したファイル)は領域を拡張しながら読み込む。
+     */
+    bool read_file(Buffer& buffer) const
+    {
+        InputFile file;
+        if (!file.open(file_path_))
+            return false;
+        record(Instrumentation::FILE_OPENS);
+
+        std::size_t capacity = file.size_hint();
+        if (capacity == 0 && !file.compressed())
+            return true;
+        char* data = buffer.allocate(capacity);
+        std::size_t filled = file.read(data, capacity);
+        while (file.compressed() && filled == capacity && !file.failed())
+        {
+            char next;
+            if (file.read(&next, 1) == 0)
+                break;
+            const std::size_t grown = capacity * 2 + 4096;
+            char* larger = buffer.allocate(grown);
+            std::memcpy(larger, data, filled);
+            larger[filled++] = next;
+            data = larger;
+            capacity = grown;
+            filled += file.read(data + filled, capacity - filled);
+        }
+        buffer.shrink(filled);
+        record(Instrumentation::BYTES_READ, static_cast<std::uint64_t>(filled));
+        return !file.compressed() || !file.failed();
+    }
+
+    bool read_file(std::string& text) const
+    {
+        InputFile file;
+        if (!file.open(file_path_))
+            return false;
+        record(Instrumentation::FILE_OPENS);
+
+        text.resize(file.size_hint());
+        std::size_t filled = file.read(&text[0], text.size());
+        while (file.compressed() && filled == text.size() && !file.failed())
+        {
+            text.resize(text.size() * 2 + 4096);
+            filled += file.read(&text[filled], text.size() - filled);
+        }
+        text.resize(filled);
+        record(Instrumentation::BYTES_READ, static_cast<std::uint64_t>(filled));
+        return !file.compressed() || !file.failed();
+    }
+
+    static bool is_whitespace(const char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+    static void trim(const char* data, Document::Span& span)
+    {
+        while (span.len > 0 && is_whitespace(data[span.pos + span.len - 1]))
+            --span.len;
+        while (span.len > 0 && is_whitespace(data[span.pos]))
+        {
+            ++span.pos;
+            --span.len;
+        }
+    }
+
+    bool is_comment_line(const char* data, const Document::Span& line) const
+    {
+        return is_comment_line(comment_prefix_list_, data, line);
+    }
+
+    static bool is_comment_line(const std::vector<std::string>& comment_prefix_list, const char* data, const Document::Span& line)
+    {
+        for (const auto &prefix : comment_prefix_list)
+        {
+            if (prefix.size() <= line.len && std::memcmp(data + line.pos, prefix.data(), prefix.size()) == 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    bool is_ignore_line(const char* data, const Document::Span& line) const
+    {
+        return line.len == 0 || is_comment_line(data, line);
+    }
+
+    /**
+     * @fn scan_lines
+     * @brief [data, data + size) の各行を解析し、セクション・フィールド・コメント行をvisitorへ通知するメソッド
+     * @param bool last 末尾の改行で終わらない行も最後の行として解析する場合はtrue
+     * @param bool has_section セクションが既に現れているかどうか(呼出し間で引き継ぐ)
+     * @param std::size_t consumed 解析を終えた行の末尾(次の行の先頭)までのバイト数
+     * @return bool 不正な行を検出した場合、もしくはvisitorがfalseを返却した場合はfalseを返却する。
+     * @note 解析規則は @ref try_get_field と同一とする。lastがfalseの場合、改行で終わらない末尾の行は解析しない。
+     */
+    template <class Visitor>
+    static bool scan_lines(const ParseRules& rules, const char* data, const std::size_t size, const bool last, bool& has_section,
+                           Visitor& visitor, std::size_t& consumed)
+    {
+        const char* const end = data + size;
+        const char* cursor = data;
+        consumed = 0;
+        while (cursor != nullptr)
+        {
+            const char* separator;
+            const char* line_end = Scanner::find_line(cursor, end, rules.field_separator, separator);
+            if (line_end == end && !last)
+                return true;
+
+            Document::Span line = { static_cast<std::size_t>(cursor - data), static_cast<std::size_t>(line_end - cursor) };
+            cursor = (line_end == end) ? nullptr : line_end + 1;
+            consumed = (cursor == nullptr) ? size : static_cast<std::size_t>(cursor - data);
+            trim(data, line);
+
+            if (line.len == 0)
+                continue;
+            if (is_comment_line(rules.comment_prefix_list, data, line))
+            {
+                if (!visitor.on_comment(data, line))
+                    return false;
+                continue;
+            }
+
+            const char* line_begin = data + line.pos;
+            const char* line_last = line_begin + line.len;
+            if (*line_begin == '[')
+            {
+                const char* close = Scanner::find(line_begin, line_last, ']');
+                if (close == line_last)
+                    return false;
+                std::size_t pos = static_cast<std::size_t>(close - line_begin);
+                if (pos == 1)
+                    return false;
+                has_section = true;
+                if (!visitor.on_section(data, Document::Span{ line.pos + 1, pos - 1 }))
+                    return false;
+            }
+            else
+            {
+                if (!has_section)
+                    return false;
+
+                // 区切り文字が空白文字の場合、走査時に見つけた位置が前後の空白に含まれることがあるため範囲を確認する。
+                if (separator != nullptr && (separator < line_begin || separator >= line_last))
+                    separator = (separator < line_begin) ? Scanner::find(line_begin, line_last, rules.field_separator) : nullptr;
+                if (separator == nullptr || separator == line_last)
+                    return false;
+
+                std::size_t pos = static_cast<std::size_t>(separator - data);
+                Document::Span field = { line.pos, pos - line.pos };
+                Document::Span value = { pos + 1, line.pos + line.len - pos - 1 };
+                trim(data, field);
+                trim(data, value);
+                if (!visitor.on_field(data, field, value))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @struct EntryBuilder
+     * @brief @ref scan_lines で解析したフィールドをドキュメントのエントリとして登録する visitor
+     * @note offset は走査範囲の先頭のファイル上の位置とし、登録する位置情報へ加算する。
+     */
+    struct EntryBuilder
+    {
+        Document& document;
+        Document::Span section;
+        std::size_t offset;
+
+        bool on_section(const char*, const Document::Span& name)
+        {
+            section = Document::Span{ name.pos + offset, name.len };
+            return true;
+        }
+
+        bool on_field(const char* data, const Document::Span& field, const Document::Span& value)
+        {
+            Document::Entry entry;
+            entry.section = section;
+            entry.field = Document::Span{ field.pos + offset, field.len };
+            entry.value = Document::Span{ value.pos + offset, value.len };
+            entry.hash = hash_key(StringRef(document.data + section.pos, section.len), StringRef(data + field.pos, field.len));
+            document.entry_storage.push_back(entry);
+            return true;
+        }
+
+        bool on_comment(const char*, const Document::Span&)
+        {
+            return true;
+        }
+    };
+
+    /**
+     * @fn parse_document
+     * @brief ファイル内容を一度走査し、フィールドの位置情報を持つドキュメントを生成するメソッド
+     * @note 解析規則は @ref try_get_field と同一とし、不正な行を検出した時点でそれ以降の行は登録しない。
+     */
+    std::shared_ptr<const Document> parse_document(std::shared_ptr<const Buffer> buffer) const
+    {
+        std::shared_ptr<Document> document = make_node<Document>(memory_resource_);
+        parse_into(parse_rules(), *document, std::move(buffer));
+        return document;
+    }
+
+    /**
+     * @fn make_document
+     * @brief @ref set_lazy_load の指定に従い、ファイル内容を解析もしくはセクション行の位置のみを記録したドキュメントを生成するメソッド
+     */
+    std::shared_ptr<const Document> make_document(std::shared_ptr<const Buffer> buffer) const
+    {
+        return lazy_load_ ? index_document(std::move(buffer)) : parse_document(std::move(buffer));
+    }
+
+    /**
+     * @fn parse_into
+     * @brief ファイル内容の全体を解析してdocumentへ登録するメソッド
+     * @see parse_document
+     */
+    static void parse_into(const ParseRules& rules, Document& document, std::shared_ptr<const Buffer> buffer)
+    {
+        const Stopwatch stopwatch(rules, Instrumentation::PARSE);
+        const char* data = buffer->data();
+        const std::size_t size = buffer->size();
+        record_lines(rules, data, data + size);
+        document.buffer = std::move(buffer);
+        document.data = data;
+
+        const std::size_t chunk_count = parallel_chunk_count(rules, size);
+        if (chunk_count > 1)
+        {
+            parse_parallel(rules, document, size, chunk_count);
+            document.build_index();
+            return;
+        }
+
+        // フィールド数は行数以下であるため、先に行数分を確保して再確保を避ける。
+        document.entry_storage.reserve(Scanner::count(data, data + size, '\n') + 1);
+
+        EntryBuilder builder = { document, { 0, 0 }, 0 };
+        bool has_section = false;
+        std::size_t consumed;
+        scan_lines(rules, data, size, true, has_section, builder, consumed);
+
+        document.build_index();
+    }
+
+    /**
+     * @fn parse_part
+     * @brief ファイル内容の [begin, end) をセクション名がsectionのセクション行のフィールドとして解析し、partへ登録するメソッド
+     * @note 範囲の途中で不正な行を検出した場合は、全体を解析した場合と同じくそれ以降の行は登録しない。
+     */
+    static void parse_part(const ParseRules& rules, Document& part, std::shared_ptr<const Buffer> buffer, const Document::Span& section,
+                           const std::size_t begin, const std::size_t end)
+    {
+        const Stopwatch stopwatch(rules, Instrumentation::PARSE);
+        part.buffer = std::move(buffer);
+        part.data = part.buffer->data();
+        const char* data = part.data + begin;
+        const std::size_t size = end - begin;
+        part.entry_storage.reserve(Scanner::count(data, data + size, '\n') + 1);
+
+        record_lines(rules, data, data + size);
+        EntryBuilder builder = { part, section, begin };
+        bool has_section = true;
+        std::size_t consumed;
+        scan_lines(rules, data, size, true, has_section, builder, consumed);
+
+        part.build_index();
+    }
+
+    /**
+     * @fn index_document
+     * @brief ファイル内容を一度走査し、セクション行の位置のみを記録した遅延解析するドキュメントを生成するメソッド
+     * @note 不正な行の検出は全体を解析する場合と同一に行い、それ以降のセクション行は記録しない。
+     *       フィールドの行は区切り文字の有無のみを確認し、エントリは生成しない。
+     */
+    std::shared_ptr<const Document> index_document(std::shared_ptr<const Buffer> buffer) const
+    {
+        const Stopwatch stopwatch(*this, Instrumentation::PARSE);
+        std::shared_ptr<Document> document = make_node<Document>(memory_resource_);
+        const char* data = buffer->data();
+        const std::size_t size = buffer->size();
+        record_lines(data, data + size);
+        document->buffer = std::move(buffer);
+        document->data = data;
+
+        typedef Document::LazyIndex::Header Header;
+        struct Indexer
+        {
+            std::vector<Header>& headers;
+            std::size_t size;
+
+            bool on_section(const char* data, const Document::Span& name)
+            {
+                // 直前のセクション行の範囲は、このセクション行の'['の位置までとする。
+                if (!headers.empty())
+                    headers.back().end = name.pos - 1;
+                const char* line_end = Scanner::find(data + name.pos, data + size, '\n');
+                Header header;
+                header.name = name;
+                header.hash = hash_section(StringRef(data + name.pos, name.len));
+                header.begin = (line_end == data + size) ? size : static_cast<std::size_t>(line_end - data) + 1;
+                header.end = size;
+                header.next = 0;
+                headers.push_back(header);
+                return true;
+            }
+
+            bool on_field(const char*, const Document::Span&, const Document::Span&)
+            {
+                return true;
+            }
+
+            bool on_comment(const char*, const Document::Span&)
+            {
+                return true;
+            }
+        };
+
+        std::unique_ptr<Document::LazyIndex> lazy(new Document::LazyIndex());
+        // 各セクション行の解析はドキュメントを保持するインスタンスの寿命によらず行えるよう、解析規則を複製して保持する。
+        lazy->rules = parse_rules();
+        Indexer indexer = { lazy->headers, size };
+        bool has_section = false;
+        std::size_t consumed;
+        scan_lines(lazy->rules, data, size, true, has_section, indexer, consumed);
+
+        document->link_names(lazy->headers, lazy->slots);
+        lazy->parts.reset(new std::atomic<const Document*>[lazy->headers.size()]);
+        for (std::size_t i = 0; i < lazy->headers.size(); ++i)
+            lazy->parts[i].store(nullptr, std::memory_order_relaxed);
+        document->lazy = std::move(lazy);
+        return document;
+    }
+
+    /**
+     * @fn complete_document
+     * @brief 全体を参照する処理のために、遅延解析するドキュメントを全体の解析結果へ置き換えるメソッド
+     * @note 返却するドキュメントは元のドキュメントと寿命を共有する。遅延解析しないドキュメントはそのまま返却する。
+     */
+    static std::shared_ptr<const Document> complete_document(const std::shared_ptr<const Document>& document)
+    {
+        if (!document || !document->lazy)
+            return document;
+        return std::shared_ptr<const Document>(document, &document->complete());
+    }
+
+    static std::size_t parallel_chunk_count(const ParseRules& rules, const std::size_t size)
+    {
+        std::size_t thread_count = (rules.parallel_load == 0) ? std::thread::hardware_concurrency() : rules.parallel_load;
+        return std::max<std::size_t>(1, std::min<std::size_t>(thread_count, size >> 20));
+    }
+
+    /**
+     * @fn run_parallel
+     * @brief task(0) から task(count - 1) を呼出し元スレッドと count - 1 個のスレッドで並列に実行するメソッド
+     */
+    template <class Task>
+    static void run_parallel(const std::size_t count, const Task& task)
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(count - 1);
+        for (std::size_t i = 1; i < count; ++i)
+            threads.emplace_back([&task, i]{ task(i); });
+        task(0);
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    /**
+     * @fn parse_parallel
+     * @brief ファイル内容を行単位でchunk_count個に分割し、並列に解析してdocumentへ登録するメソッド
+     * @note 分割位置がセクションの途中となる場合、先頭のセクション行より前のフィールドは直前の分割範囲で
+     *       最後に現れたセクションに属するものとして解決する。解析結果は @ref parse_document の逐次解析と同一とする。
+     */
+    static void parse_parallel(const ParseRules& rules, Document& document, const std::size_t size, const std::size_t chunk_count)
+    {
+        struct Chunk
+        {
+            const char* first;
+            const char* last;
+            std::vector<Document::Entry> entries;
+            std::size_t inherited;        ///< 先頭のセクション行より前に現れたフィールド数
+            bool has_section;
+            Document::Span section;       ///< 範囲内で最後に現れたセクション
+            bool completed;               ///< 不正な行を検出せずに末尾まで解析したかどうか
+            Document::Span owner;         ///< 先頭のセクション行より前のフィールドが属するセクション
+            std::size_t offset;           ///< document.entry_storage 上の登録位置
+        };
+
+        struct Collector
+        {
+            Chunk& chunk;
+            std::size_t offset;
+
+            bool on_section(const char*, const Document::Span& name)
+            {
+                chunk.section = { name.pos + offset, name.len };
+                chunk.has_section = true;
+                return true;
+            }
+
+            bool on_field(const char* data, const Document::Span& field, const Document::Span& value)
+            {
+                Document::Entry entry;
+                entry.section = chunk.section;
+                entry.field = { field.pos + offset, field.len };
+                entry.value = { value.pos + offset, value.len };
+                entry.hash = 0;
+                if (chunk.has_section)
+                    entry.hash = hash_key(StringRef(data + chunk.section.pos - offset, chunk.section.len), StringRef(data + field.pos, field.len));
+                else
+                    ++chunk.inherited;
+                chunk.entries.push_back(entry);
+                return true;
+            }
+
+            bool on_comment(const char*, const Document::Span&)
+            {
+                return true;
+            }
+        };
+
+        const char* const data = document.data;
+        const char* const end = data + size;
+        std::vector<Chunk> chunks(chunk_count);
+        const char* first = data;
+        for (std::size_t i = 0; i < chunk_count; ++i)
+        {
+            const char* last = end;
+            if (i + 1 < chunk_count)
+            {
+                last = Scanner::find(std::max(first, data + size / chunk_count * (i + 1)), end, '\n');
+                if (last != end)
+                    ++last;
+            }
+            Chunk& chunk = chunks[i];
+            chunk.first = first;
+            chunk.last = last;
+            chunk.inherited = 0;
+            chunk.has_section = false;
+            chunk.section = { 0, 0 };
+            chunk.completed = false;
+            chunk.owner = { 0, 0 };
+            chunk.offset = 0;
+            first = last;
+        }
+
+        // 先頭以外の範囲はセクションの途中から始まるものとして解析し、所属セクションは後で解決する。
+        run_parallel(chunk_count, [&](const std::size_t i)
+        {
+            Chunk& chunk = chunks[i];
+            chunk.entries.reserve(Scanner::count(chunk.first, chunk.last, '\n') + 1);
+            Collector collector = { chunk, static_cast<std::size_t>(chunk.first - data) };
+            bool has_section = (i != 0);
+            std::size_t consumed;
+            chunk.completed = scan_lines(rules, chunk.first, static_cast<std::size_t>(chunk.last - chunk.first), true, has_section, collector, consumed);
+        });
+
+        bool has_section = false;
+        Document::Span section = { 0, 0 };
+        std::size_t used = 0;
+        std::size_t total = 0;
+        for (; used < chunk_count; ++used)
+        {
+            Chunk& chunk = chunks[used];
+            // セクション行より前にフィールドが現れた場合、逐次解析ではその行で解析を終える。
+            if (chunk.inherited != 0 && !has_section)
+                break;
+            chunk.owner = section;
+            chunk.offset = total;
+            total += chunk.entries.size();
+            if (chunk.has_section)
+            {
+                section = chunk.section;
+                has_section = true;
+            }
+            if (!chunk.completed)
+            {
+                ++used;
+                break;
+            }
+        }
+
+        document.entry_storage.resize(total);
+        if (used != 0)
+        {
+            run_parallel(used, [&](const std::size_t i)
+            {
+                Chunk& chunk = chunks[i];
+                const StringRef owner(data + chunk.owner.pos, chunk.owner.len);
+                for (std::size_t j = 0; j < chunk.inherited; ++j)
+                {
+                    Document::Entry& entry = chunk.entries[j];
+                    entry.section = chunk.owner;
+                    entry.hash = hash_key(owner, StringRef(data + entry.field.pos, entry.field.len));
+                }
+                std::copy(chunk.entries.begin(), chunk.entries.end(), document.entry_storage.begin() + static_cast<std::ptrdiff_t>(chunk.offset));
+            });
+        }
+    }
+
+    std::shared_ptr<Buffer> make_buffer(const std::string& text) const
+    {
+        std::shared_ptr<Buffer> buffer = make_node<Buffer>(memory_resource_);
+        if (!text.empty())
+            std::memcpy(buffer->allocate(text.size()), text.data(), text.size());
+        return buffer;
+    }
+
+    bool load_document() const
+    {
+        if (!shared_name_.empty())
+            return attach_document();
+        const bool result = read_document();
+        if (!published_name_.empty())
+            publish_document();
+        return result;
+    }
+
+    /**
+     * @fn is_current
+     * @brief ドキュメントが読込元(iniファイルもしくは共有メモリ)の最新の内容であるかどうかの判定メソッド
+     * @note 共有メモリを参照している場合は管理領域の世代のみを比較し、ファイルを参照しない。
+     */
+    bool is_current(const Document& document) const
+    {
+        if (!shared_name_.empty())
+            return shared_control_ && document.buffer->generation == shared_generation();
+        return document.buffer->stamp == FileStamp::of(file_path_);
+    }
+
+    bool read_document() const
+    {
+        const FileStamp stamp = FileStamp::of(file_path_);
+        // キャッシュファイルから読み込んだドキュメントはファイル内容を持たず遅延書込を反映できないため、遅延書込中は用いない。
+        const bool use_cache = !cache_path_.empty() && stamp.exists && write_behind_interval_.count() == 0;
+        if (use_cache)
+        {
+            std::shared_ptr<const Document> cached = load_image(stamp);
+            if (cached)
+            {
+                document_.store(std::move(cached));
+                return true;
+            }
+        }
+
+        std::shared_ptr<Buffer> buffer = make_node<Buffer>(memory_resource_);
+        buffer->stamp = stamp;
+        // 圧縮したファイルはマップした領域を直接解析できないため、展開して読み込む。
+        const bool map = memory_map_ && !is_compressed_input(file_path_);
+        bool result = map ? buffer->map(file_path_) : read_file(*buffer);
+        if (result && map)
+        {
+            record(Instrumentation::FILE_OPENS);
+            record(Instrumentation::BYTES_READ, buffer->size());
+        }
+        // 途中で読込に失敗した内容(途切れた圧縮ファイル等)は返却しない。
+        if (!result)
+        {
+            buffer = make_node<Buffer>(memory_resource_);
+            buffer->stamp = stamp;
+        }
+        std::shared_ptr<const Document> document = use_cache ? parse_document(std::move(buffer)) : make_document(std::move(buffer));
+        if (result && use_cache)
+            save_image(*document);
+        // ファイルへ未反映の遅延書込は読み込み直した内容へ反映し直す。
+        if (!dirty_.empty())
+        {
+            std::shared_ptr<const Document> overlaid = overlay_document(*complete_document(document), dirty_);
+            if (overlaid)
+                document = std::move(overlaid);
+        }
+        document_.store(std::move(document));
+        return result;
+    }
+
+    /**
+     * @fn post_async
+     * @brief taskを専用スレッドで実行し、戻り値もしくは送出した例外をfutureへ格納するメソッド
+     */
+    std::future<bool> post_async(const std::function<bool()>& task) const
+    {
+        std::shared_ptr<std::promise<bool>> promise = std::make_shared<std::promise<bool>>();
+        std::future<bool> future = promise->get_future();
+        executor_.post([task, promise]
+        {
+            try
+            {
+                promise->set_value(task());
+            }
+            catch (...)
+            {
+                promise->set_exception(std::current_exception());
+            }
+        });
+        return future;
+    }
+
+    /**
+     * @fn reparse_document
+     * @brief 解析規則を変更し、保持しているドキュメントを新たな解析規則で解析し直すメソッド
+     * @note 監視スレッド・遅延書込・非同期処理はロックを取得して解析規則を参照するため、変更も同一のロック内で行う。
+     */
+    template <class Assign>
+    void reparse_document(const Assign& assign)
+    {
+        std::lock_guard<Mutex> lock(write_mutex_);
+        assign();
+        std::shared_ptr<const Document> document = document_.load();
+        if (!document)
+        {
+            // 解析規則の不一致により破棄した共有メモリのドキュメントは、新たな解析規則で参照し直す。
+            if (!shared_name_.empty())
+                attach_document();
+            return;
+        }
+        // キャッシュファイル・共有メモリは解析規則毎に作成するため、読込元から読み込み直す。
+        if (document->compiled)
+        {
+            // 共有メモリが新たな解析規則と一致しない場合は、改めて参照した場合と同じく旧規則のドキュメントを用いない。
+            if (!load_document() && !shared_name_.empty())
+                document_.store(nullptr);
+            return;
+        }
+        document_.store(make_document(document->buffer));
+        if (!published_name_.empty())
+            publish_document();
+    }
+
+    /**
+     * @fn publish_document
+     * @brief 保持しているドキュメントを新たな世代として共有メモリへ公開するメソッド
+     * @note 新たな世代の共有メモリへ書き込んだ後に管理領域の世代を更新し、1つ前の世代の名前を削除する。
+     *       旧世代をマップ済みのプロセスは、マップを解放するまで旧世代の内容を参照できる。
+     */
+    bool publish_document() const
+    {
+        std::shared_ptr<const Document> document = complete_document(document_.load());
+        if (!document)
+            return false;
+
+        if (!published_control_)
+        {
+            std::shared_ptr<SharedSegment> control = std::make_shared<SharedSegment>();
+            if (!control->create(published_name_, sizeof(SharedControl)))
+                return false;
+            SharedControl* header = reinterpret_cast<SharedControl*>(control->data());
+            if (std::memcmp(header->magic, shared_magic(), sizeof(header->magic)) != 0)
+            {
+                header->generation.store(0, std::memory_order_relaxed);
+                std::memcpy(header->magic, shared_magic(), sizeof(header->magic));
+            }
+            published_control_ = std::move(control);
+        }
+
+        SharedControl* control = reinterpret_cast<SharedControl*>(published_control_->data());
+        const std::uint64_t generation = control->generation.load(std::memory_order_relaxed) + 1;
+        const std::string image = build_image(*document);
+        const std::string image_name = shared_image_name(published_name_, generation);
+        // 異常終了した公開側が残した同名の共有メモリは使用しない。
+        SharedSegment::remove(image_name);
+        std::shared_ptr<SharedSegment> segment = std::make_shared<SharedSegment>();
+        if (!segment->create(image_name, image.size()))
+            return false;
+        std::memcpy(segment->data(), image.data(), image.size());
+        record(Instrumentation::WRITES);
+
+        control->generation.store(generation, std::memory_order_release);
+        SharedSegment::remove(shared_image_name(published_name_, generation - 1));
+        published_image_ = std::move(segment);
+        return true;
+    }
+
+    /**
+     * @fn attach_document
+     * @brief 共有メモリへ公開された最新の世代のドキュメントを参照するメソッド
+     */
+    bool attach_document() const
+    {
+        if (!shared_control_)
+        {
+            std::shared_ptr<Buffer> control = make_node<Buffer>(memory_resource_);
+            if (!control->map_shared(shared_name_) || control->size() < sizeof(SharedControl)
+             || std::memcmp(control->data(), shared_magic(), sizeof(SharedControl::magic)) != 0)
+                return false;
+            shared_control_ = std::move(control);
+        }
+
+        // 世代の取得後に公開側が更新すると旧世代の名前は削除されるため、世代を取得し直して再度試みる。
+        for (int attempt = 0; attempt < 8; ++attempt)
+        {
+            const std::uint64_t generation = shared_generation();
+            if (generation == 0)
+                return false;
+            std::shared_ptr<Buffer> buffer = make_node<Buffer>(memory_resource_);
+            if (!buffer->map_shared(shared_image_name(shared_name_, generation)))
+                continue;
+            record(Instrumentation::FILE_OPENS);
+            record(Instrumentation::BYTES_READ, buffer->size());
+            buffer->generation = generation;
+            std::shared_ptr<const Document> document = open_image(std::move(buffer), false);
+            if (!document)
+                return false;
+            document_.store(std::move(document));
+            return true;
+        }
+        return false;
+    }
+
+    std::uint64_t shared_generation() const
+    {
+        return reinterpret_cast<const SharedControl*>(shared_control_->data())->generation.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @struct ImageHeader
+     * @brief キャッシュファイルの先頭に格納する情報
+     * @note 各配列はファイル先頭からの位置で表し、ポインタを含まないため任意のアドレスにマップして参照できる。
+     *       エントリの位置情報は pool_offset からの位置を表す。
+     */
+    struct ImageHeader
+    {
+        char magic[8];
+        std::uint32_t byte_order;
+        std::uint32_t version;
+        std::uint32_t entry_size;
+        std::uint32_t value_size;
+        std::uint64_t config;
+        std::int64_t source_size;
+        std::int64_t source_modified;
+        std::uint64_t entry_count;
+        std::uint64_t slot_count;
+        std::uint64_t entries_offset;
+        std::uint64_t values_offset;
+        std::uint64_t slots_offset;
+        std::uint64_t pool_offset;
+        std::uint64_t pool_size;
+    };
+
+    static const char* image_magic() { return "INIIMAGE"; }
+
+    /**
+     * @fn parse_config
+     * @brief 解析結果に影響する設定(区切り文字・コメント行の先頭文字列)のハッシュ値の算出メソッド
+     */
+    std::uint64_t parse_config() const
+    {
+        std::uint64_t hash = hash_bytes(&field_separator_, 1, 0xcbf29ce484222325ULL);
+        for (const auto& prefix : comment_prefix_list_)
+        {
+            const std::uint64_t size = prefix.size();
+            hash = hash_bytes(reinterpret_cast<const char*>(&size), sizeof(size), hash);
+            hash = hash_bytes(prefix.data(), prefix.size(), hash);
+        }
+        return hash;
+    }
+
+    static std::size_t align_image(const std::size_t size)
+    {
+        return (size + 7) & ~static_cast<std::size_t>(7);
+    }
+
+    /**
+     * @fn save_image
+     * @brief 解析したドキュメントをキャッシュファイルへ書き込むメソッド
+     */
+    bool save_image(const Document& document) const
+    {
+        record(Instrumentation::WRITES);
+        return write_file(cache_path_, build_image(document));
+    }
+
+    /**
+     * @fn build_image
+     * @brief ドキュメントを任意のアドレスから参照できる連続した領域へ変換するメソッド
+     * @note セクション名・フィールド名・値のみを連続して格納し、コメント行や空白は格納しない。
+     *       数値・真理値はエントリ毎に変換して格納する。
+     */
+    std::string build_image(const Document& document) const
+    {
+        typedef Document::Entry Entry;
+        typedef Document::PackedValue PackedValue;
+        typedef Document::TypedValue TypedValue;
+
+        std::string pool;
+        std::vector<Entry> entries(document.entries.begin(), document.entries.end());
+        std::vector<PackedValue> values(entries.size());
+        std::size_t section_pos = static_cast<std::size_t>(-1);
+        std::size_t section_offset = 0;
+        for (std::size_t i = 0; i < entries.size(); ++i)
+        {
+            Entry& entry = entries[i];
+            // 同じセクション行に属するエントリはセクション名を共有する。
+            if (entry.section.pos != section_pos)
+            {
+                section_pos = entry.section.pos;
+                section_offset = pool.size();
+                pool.append(document.data + entry.section.pos, entry.section.len);
+            }
+            entry.section.pos = section_offset;
+
+            pool.append(document.data + entry.field.pos, entry.field.len);
+            entry.field.pos = pool.size() - entry.field.len;
+
+            const StringRef value(document.data + entry.value.pos, entry.value.len);
+            pool.append(value.data(), value.size());
+            entry.value.pos = pool.size() - entry.value.len;
+
+            PackedValue& packed = values[i];
+            packed.state = TypedValue::INT_CACHED | TypedValue::DOUBLE_CACHED | TypedValue::BOOL_CACHED;
+            packed.int_value = 0;
+            packed.double_bits = 0;
+            int int_value;
+            if (convert_int(value, int_value))
+            {
+                packed.state |= TypedValue::INT_VALID;
+                packed.int_value = int_value;
+            }
+            double double_value;
+            if (convert_double(value, double_value))
+            {
+                packed.state |= TypedValue::DOUBLE_VALID;
+                std::memcpy(&packed.double_bits, &double_value, sizeof(double_value));
+            }
+            bool bool_value;
+            if (convert_bool(value, bool_value))
+                packed.state |= TypedValue::BOOL_VALID | (bool_value ? TypedValue::BOOL_TRUE : 0u);
+        }
+
+        ImageHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, image_magic(), sizeof(header.magic));
+        header.byte_order = 0x01020304;
+        header.version = 1;
+        header.entry_size = sizeof(Entry);
+        header.value_size = sizeof(PackedValue);
+        header.config = parse_config();
+        header.source_size = document.buffer->stamp.size;
+        header.source_modified = document.buffer->stamp.modified;
+        header.entry_count = entries.size();
+        header.slot_count = document.slots.size();
+        header.entries_offset = align_image(sizeof(ImageHeader));
+        header.values_offset = align_image(header.entries_offset + sizeof(Entry) * entries.size());
+        header.slots_offset = align_image(header.values_offset + sizeof(PackedValue) * values.size());
+        header.pool_offset = align_image(header.slots_offset + sizeof(std::uint32_t) * document.slots.size());
+        header.pool_size = pool.size();
+
+        std::string image(static_cast<std::size_t>(header.pool_offset + header.pool_size), '\0');
+        std::memcpy(&image[0], &header, sizeof(header));
+        if (!entries.empty())
+        {
+            std::memcpy(&image[static_cast<std::size_t>(header.entries_offset)], entries.data(), sizeof(Entry) * entries.size());
+            std::memcpy(&image[static_cast<std::size_t>(header.values_offset)], values.data(), sizeof(PackedValue) * values.size());
+        }
+        std::memcpy(&image[static_cast<std::size_t>(header.slots_offset)], document.slots.data(), sizeof(std::uint32_t) * document.slots.size());
+        if (!pool.empty())
+            std::memcpy(&image[static_cast<std::size_t>(header.pool_offset)], pool.data(), pool.size());
+        return image;
+    }
+
+    /**
+     * @fn load_image
+     * @brief キャッシュファイルをメモリマップしてドキュメントとして読み込むメソッド
+     * @return std::shared_ptr<const Document> キャッシュファイルが存在しない、破損している、もしくは
+     *         stamp・解析規則が作成時と一致しない場合はnullptrを返却する。
+     */
+    std::shared_ptr<const Document> load_image(const FileStamp& stamp) const
+    {
+        std::shared_ptr<Buffer> buffer = make_node<Buffer>(memory_resource_);
+        if (!buffer->map(cache_path_))
+            return nullptr;
+        record(Instrumentation::FILE_OPENS);
+        record(Instrumentation::BYTES_READ, buffer->size());
+        buffer->stamp = stamp;
+        return open_image(std::move(buffer), true);
+    }
+
+    /**
+     * @fn open_image
+     * @brief @ref build_image で変換した領域をドキュメントとして参照するメソッド
+     * @param bool check_source trueの場合は作成元のファイルの更新日時・サイズがbufferのstampと一致することも確認する。
+     * @return std::shared_ptr<const Document> 破損している、もしくは解析規則・作成元が一致しない場合はnullptrを返却する。
+     */
+    std::shared_ptr<const Document> open_image(std::shared_ptr<Buffer> buffer, const bool check_source) const
+    {
+        typedef Document::Entry Entry;
+        typedef Document::PackedValue PackedValue;
+
+        if (buffer->size() < sizeof(ImageHeader))
+            return nullptr;
+
+        const char* base = buffer->data();
+        const std::uint64_t size = buffer->size();
+        ImageHeader header;
+        std::memcpy(&header, base, sizeof(header));
+        if (std::memcmp(header.magic, image_magic(), sizeof(header.magic)) != 0 || header.byte_order != 0x01020304 || header.version != 1
+         || header.entry_size != sizeof(Entry) || header.value_size != sizeof(PackedValue) || header.config != parse_config()
+         || (check_source && (header.source_size != buffer->stamp.size || header.source_modified != buffer->stamp.modified)))
+            return nullptr;
+
+        // 破損したファイルを参照しないよう、各配列と位置情報が範囲内であることを確認する。
+        auto fits = [size](const std::uint64_t offset, const std::uint64_t count, const std::uint64_t item_size)
+        {
+            return offset % 8 == 0 && offset <= size && count <= (size - offset) / item_size;
+        };
+        if (!fits(header.entries_offset, header.entry_count, sizeof(Entry)) || !fits(header.values_offset, header.entry_count, sizeof(PackedValue))
+         || !fits(header.slots_offset, header.slot_count, sizeof(std::uint32_t)) || header.pool_offset > size || header.pool_size > size - header.pool_offset
+         || header.slot_count == 0 || (header.slot_count & (header.slot_count - 1)) != 0 || header.entry_count >= header.slot_count)
+            return nullptr;
+
+        const Entry* entries = reinterpret_cast<const Entry*>(base + header.entries_offset);
+        const std::uint32_t* slots = reinterpret_cast<const std::uint32_t*>(base + header.slots_offset);
+        auto within = [&header](const Document::Span& span)
+        {
+            return span.pos <= header.pool_size && span.len <= header.pool_size - span.pos;
+        };
+        for (std::uint64_t i = 0; i < header.entry_count; ++i)
+        {
+            if (!within(entries[i].section) || !within(entries[i].field) || !within(entries[i].value))
+                return nullptr;
+        }
+        bool has_empty_slot = false;
+        for (std::uint64_t i = 0; i < header.slot_count; ++i)
+        {
+            if (slots[i] > header.entry_count)
+                return nullptr;
+            has_empty_slot = has_empty_slot || slots[i] == 0;
+        }
+        if (!has_empty_slot)
+            return nullptr;
+
+        std::shared_ptr<Document> document = make_node<Document>(memory_resource_);
+        document->data = base + header.pool_offset;
+        document->entries.items = entries;
+        document->entries.count = static_cast<std::size_t>(header.entry_count);
+        document->slots.items = slots;
+        document->slots.count = static_cast<std::size_t>(header.slot_count);
+        document->packed_values = reinterpret_cast<const PackedValue*>(base + header.values_offset);
+        document->build_sections();
+        document->compiled = true;
+        document->buffer = std::move(buffer);
+        return document;
+    }
+
+    /**
+     * @fn try_get_value
+     * @brief フィールド値の参照取得メソッド
+     * @note ドキュメントを保持している場合はその内容を直接参照し、保持していない場合はファイルを走査して
+     *       storageに複製した値を参照する。参照中に再読込されても値が無効にならないよう、documentに参照元を保持する。
+     */
+    bool try_get_value(const StringRef& target_section, const StringRef& target_field, std::shared_ptr<const Document>& document,
+                       std::string& storage, StringRef& value) const
+    {
+        document = document_.load();
+        if (!document)
+        {
+            const bool found = try_get_field(target_section, target_field, storage);
+            record_lookup(found);
+            if (!found)
+                return false;
+            value = StringRef(storage);
+            return true;
+        }
+
+        return find_value(*document, target_section, target_field, value);
+    }
+
+    /**
+     * @fn try_get_typed
+     * @brief フィールド値を指定の型へ変換して取得するメソッド
+     * @note ドキュメントを保持している場合は @ref find_typed によりエントリ毎の変換結果を再利用する。
+     */
+    template <class T>
+    bool try_get_typed(const StringRef& target_section, const StringRef& target_field, T& value) const
+    {
+        std::shared_ptr<const Document> document = document_.load();
+        if (document)
+            return find_typed(*document, target_section, target_field, value);
+
+        std::string storage;
+        const bool found = try_get_field(target_section, target_field, storage);
+        record_lookup(found);
+        if (!found)
+            return false;
+        if (!convert_value(StringRef(storage), value))
+        {
+            record(Instrumentation::CONVERSION_FAILURES);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @fn find_typed
+     * @brief ドキュメント上のフィールド値を指定の型へ変換して取得するメソッド
+     * @note 変換結果はエントリ毎に保持し、同一ドキュメントに対する2回目以降の取得では文字列の変換を行わない。
+     *       書込・再読込時は新たなドキュメントに差し替わるため、変換結果も破棄される。
+     */
+    template <class T>
+    bool find_typed(const Document& document, const StringRef& target_section, const StringRef& target_field, T& value) const
+    {
+        return convert_entry(document, document.find(target_section, target_field), value);
+    }
+
+    /**
+     * @fn convert_entry
+     * @brief エントリの値を指定の型へ変換して取得するメソッド
+     * @note 検索結果および変換の成否を計測値として通知する。
+     */
+    template <class T>
+    bool convert_entry(const Document& document, const Document::Entry* entry, T& value) const
+    {
+        const bool found = entry != nullptr && entry->value.len != 0;
+        record_lookup(found);
+        if (!found)
+            return false;
+        if (!document.convert(*entry, value))
+        {
+            record(Instrumentation::CONVERSION_FAILURES);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @fn bind
+     * @brief 読取キーに対応するドキュメント上のエントリの取得メソッド
+     * @note 読取キーが同じドキュメントで解決済みの場合は記録した位置を返却し、異なる場合のみ検索して記録する。
+     */
+    static const Document::Entry* bind(const Document& document, Key& key)
+    {
+        // 遅延解析するドキュメントのエントリは解析したセクション行毎に別の配列に格納するため、位置を記録しない。
+        if (document.lazy)
+            return document.find(key.section_, key.field_, key.hash_);
+        if (key.serial_ != document.serial)
+        {
+            const Document::Entry* entry = document.find(key.section_, key.field_, key.hash_);
+            key.index_ = (entry == nullptr) ? 0 : static_cast<std::size_t>(entry - document.entries.data()) + 1;
+            key.serial_ = document.serial;
+        }
+        return (key.index_ == 0) ? nullptr : &document.entries[key.index_ - 1];
+    }
+
+    template <class T>
+    bool try_get_typed(const Symbol& section, const Symbol& field, T& value) const
+    {
+        std::shared_ptr<const Document> document = complete_document(document_.load());
+        if (!document)
+            return try_get_typed(name_of(section), name_of(field), value);
+        const Document::SymbolIndex& index = document->symbol_index(*symbols_);
+        return convert_entry(*document, index.find(*document, section.id(), field.id()), value);
+    }
+
+    template <class T>
+    bool try_get_typed(Key& key, T& value) const
+    {
+        std::shared_ptr<const Document> document = document_.load();
+        if (document)
+            return find_typed(*document, key, value);
+        return try_get_typed(key.section_, key.field_, value);
+    }
+
+    template <class T>
+    bool find_typed(const Document& document, Key& key, T& value) const
+    {
+        return convert_entry(document, bind(document, key), value);
+    }
+
+    bool find_value(const Document& document, const StringRef& target_section, const StringRef& target_field, StringRef& value) const
+    {
+        const Document::Entry* entry = document.find(target_section, target_field);
+        record_lookup(entry != nullptr && entry->value.len != 0);
+        if (entry == nullptr || entry->value.len == 0)
+            return false;
+
+        value = StringRef(document.data + entry->value.pos, entry->value.len);
+        return true;
+    }
+
+    static bool equals_ignore_case(const StringRef& str, const char* upper)
+    {
+        std::size_t i = 0;
+        for (; i < str.size() && upper[i] != '\0'; ++i)
+        {
+            if (static_cast<char>(::toupper(str.data()[i])) != upper[i])
+                return false;
+        }
+        return i == str.size() && upper[i] == '\0';
+    }
+
+    /**
+     * @fn terminate
+     * @brief strtol等へ渡すためのヌル終端文字列を取得するメソッド
+     * @note 値が短い場合は呼出し側のスタック上のbufferへ複製し、ヒープ確保を行わない。
+     */
+    static const char* terminate(const StringRef& str, char* buffer, const std::size_t buffer_size, std::string& storage)
+    {
+        if (str.size() < buffer_size)
+        {
+            std::memcpy(buffer, str.data(), str.size());
+            buffer[str.size()] = '\0';
+            return buffer;
+        }
+        storage.assign(str.data(), str.size());
+        return storage.c_str();
+    }
+
+    static bool convert_bool(const StringRef& str, bool& value)
+    {
+        if (equals_ignore_case(str, "TRUE") || equals_ignore_case(str, "1"))
+            value = true;
+        else if (equals_ignore_case(str, "FALSE") || equals_ignore_case(str, "0"))
+            value = false;
+        else
+            return false;
+        return true;
+    }
+
+    /**
+     * @fn parse_unsigned
+     * @brief 符号なし整数の変換メソッド
+     * @note 文字列全体が指定の基数の数字である場合のみ成功とし、一度の走査で変換する。
+     */
+    static bool parse_unsigned(const char* first, const char* last, const int base, unsigned long long& value)
+    {
+        if (first == last)
+            return false;
+#if INI_HAS_CHARCONV
+        std::from_chars_result result = std::from_chars(first, last, value, base);
+        return result.ec == std::errc() && result.ptr == last;
+#else
+        unsigned long long result = 0;
+        for (; first != last; ++first)
+        {
+            int digit;
+            if (*first >= '0' && *first <= '9')
+                digit = *first - '0';
+            else if (*first >= 'a' && *first <= 'z')
+                digit = *first - 'a' + 10;
+            else if (*first >= 'A' && *first <= 'Z')
+                digit = *first - 'A' + 10;
+            else
+                return false;
+
+            if (digit >= base || result > (ULLONG_MAX - static_cast<unsigned long long>(digit)) / static_cast<unsigned long long>(base))
+                return false;
+            result = result * static_cast<unsigned long long>(base) + static_cast<unsigned long long>(digit);
+        }
+        value = result;
+        return true;
+#endif
+    }
+
+    /**
+     * @fn convert_int
+     * @brief 整数値への変換メソッド
+     * @note 10進数、および "0x" で始まる16進数を受け付ける。int の範囲外の値は変換失敗とする。
+     */
+    static bool convert_int(const StringRef& str, int& value)
+    {
+        const char* first = str.data();
+        const char* last = first + str.size();
+
+        bool negative = false;
+        if (first != last && (*first == '+' || *first == '-'))
+        {
+            negative = (*first == '-');
+            ++first;
+        }
+
+        int base = 10;
+        if (last - first > 2 && first[0] == '0' && (first[1] == 'x' || first[1] == 'X'))
+        {
+            base = 16;
+            first += 2;
+        }
+
+        unsigned long long magnitude;
+        if (!parse_unsigned(first, last, base, magnitude))
+            return false;
+
+        const unsigned long long limit = negative ? static_cast<unsigned long long>(INT_MAX) + 1 : static_cast<unsigned long long>(INT_MAX);
+        if (magnitude > limit)
+            return false;
+
+        value = negative ? static_cast<int>(-static_cast<long long>(magnitude)) : static_cast<int>(magnitude);
+        return true;
+    }
+
+    /**
+     * @fn convert_double
+     * @brief 浮動小数点値への変換メソッド
+     * @note 先頭から数値として解釈できる部分までを変換する。(std::stod と同様)
+     */
+    static bool convert_double(const StringRef& str, double& value)
+    {
+#if INI_HAS_CHARCONV_FLOAT
+        const char* first = str.data();
+        const char* last = first + str.size();
+
+        bool negative = false;
+        if (first != last && (*first == '+' || *first == '-'))
+        {
+            negative = (*first == '-');
+            ++first;
+        }
+        if (first != last && (*first == '+' || *first == '-'))
+            return false;
+
+        std::chars_format format = std::chars_format::general;
+        if (last - first > 2 && first[0] == '0' && (first[1] == 'x' || first[1] == 'X'))
+        {
+            format = std::chars_format::hex;
+            first += 2;
+        }
+
+        double result;
+        std::from_chars_result converted = std::from_chars(first, last, result, format);
+        if (converted.ec != std::errc())
+            return false;
+        value = negative ? -result : result;
+        return true;
+#else
+        char buffer[64];
+        std::string storage;
+        const char* c_str = terminate(str, buffer, sizeof(buffer), storage);
+
+        char* endptr;
+        errno = 0;
+        double result = std::strtod(c_str, &endptr);
+        if (endptr == c_str || errno == ERANGE)
+            return false;
+        value = result;
+        return true;
+#endif
+    }
+
+    static bool convert_value(const StringRef& str, bool& value) { return convert_bool(str, value); }
+    static bool convert_value(const StringRef& str, int& value) { return convert_int(str, value); }
+    static bool convert_value(const StringRef& str, double& value) { return convert_double(str, value); }
+    static bool convert_value(const StringRef& str, std::string& value) { value.assign(str.data(), str.size()); return true; }
+
+    void trim(std::string& str) const
+    {
+        const char *whitespaces = " \t\n\r\f\v";
+        auto lascurrent_tpos = str.find_last_not_of(whitespaces);
+        if (lascurrent_tpos == std::string::npos)
+        {
+            str.clear();
+            return;
+        }
+        str.erase(lascurrent_tpos + 1);
+        str.erase(0, str.find_first_not_of(whitespaces));
+    }
+
+    bool is_ignore_line(const std::string& line) const
+    {
+        if (line.size() == 0)
+            return true;
+
+        for (const auto &prefix : comment_prefix_list_)
+        {
+            std::size_t pos = line.find(prefix);
+            if (pos == 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    bool try_get_field(const StringRef& target_section, const StringRef& target_field, std::string& value) const
+    {
+        std::string text;
+        if (!read_file(text))
+            return false;
+        std::istringstream iss(text);
+
+        int line_num = 0;
+        // 走査を終えた行数は戻り値によらず通知する。
+        struct LineTally
+        {
+            const Ini& ini;
+            const int& line_num;
+            ~LineTally() { ini.record(Instrumentation::LINES_SCANNED, static_cast<std::uint64_t>(line_num)); }
+        } tally = { *this, line_num };
+        (void)tally;
+        // 行毎に文字列を生成しないよう、領域を再利用する。
+        std::string current_section = "";
+        std::string current_field;
+        std::string current_value;
+        std::string line;
+
+        while (!iss.eof() && !iss.fail())
+        {
+            std::getline(iss, line, '\n');
+            trim(line);
+            ++line_num;
+
+            if (is_ignore_line(line))
+                continue;
+
+            if (line[0] == '[')
+            {
+                std::size_t pos = line.find("]");
+                if (pos == std::string::npos)
+                    return false;
+                if (pos == 1)
+                    return false;
+                current_section.assign(line, 1, pos - 1);
+            }
+            else
+            {
+                if (current_section == "")
+                    return false;
+
+                std::size_t pos = line.find(field_separator_);
+
+                if (pos == std::string::npos)
+                {
+                    return false;
+                }
+                else
+                {
+                    current_field.assign(line, 0, pos);
+                    trim(current_field);
+                    current_value.assign(line, pos + 1, std::string::npos);
+                    trim(current_value);
+
+                    if (target_section.equals(current_section) && target_field.equals(current_field))
+                    {
+                        value = current_value;
+                        return (value.size() != 0) ? true : false;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @fn write_file
+     * @brief ファイル内容を不可分に置き換えるメソッド
+     * @note 同一ディレクトリの一時ファイルへ一度の書込とfsyncを行った後、元のファイルへ上書きで名前を変更する。
+     *       書込途中で異常終了した場合も元のファイルは変更前の内容のまま残る。
+     *       @ref is_compressed_output の場合はgzip形式へ圧縮した内容を書き込む。
+     */
+    bool write_file(const std::string& content) const
+    {
+        record(Instrumentation::WRITES);
+#if defined(INI_WITH_ZLIB)
+        if (is_compressed_output(file_path_))
+        {
+            std::string compressed;
+            return compress(content, compressed) && write_file(file_path_, compressed);
+        }
+#endif
+        return write_file(file_path_, content);
+    }
+
+    static bool write_file(const std::string& file_path, const std::string& content)
+    {
+        static std::atomic<unsigned int> sequence(0);
+
+#if defined(_WIN32)
+        const std::string target = file_path;
+        std::string temp_path;
+        HANDLE file = INVALID_HANDLE_VALUE;
+        while (file == INVALID_HANDLE_VALUE)
+        {
+            temp_path = target + ".tmp." + std::to_string(GetCurrentProcessId()) + "." + std::to_string(sequence++);
+            file = CreateFileA(temp_path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE && GetLastError() != ERROR_FILE_EXISTS)
+                return false;
+        }
+
+        bool result = true;
+        std::size_t written = 0;
+        while (result && written < content.size())
+        {
+            DWORD size = 0;
+            const DWORD chunk = static_cast<DWORD>(std::min<std::size_t>(content.size() - written, 0x40000000));
+            result = WriteFile(file, content.data() + written, chunk, &size, nullptr) != 0;
+            written += size;
+        }
+        result = result && FlushFileBuffers(file) != 0;
+        CloseHandle(file);
+
+        if (!result || !MoveFileExA(temp_path.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+        {
+            DeleteFileA(temp_path.c_str());
+            return false;
+        }
+        return true;
+#else
+        // シンボリックリンクの場合はリンク自体ではなくリンク先を置き換える。
+        std::string target = file_path;
+        struct stat st;
+        const bool exists = ::stat(target.c_str(), &st) == 0;
+        struct stat lst;
+        if (exists && ::lstat(target.c_str(), &lst) == 0 && S_ISLNK(lst.st_mode))
+        {
+            char* resolved = ::realpath(target.c_str(), nullptr);
+            if (resolved == nullptr)
+                return false;
+            target = resolved;
+            std::free(resolved);
+        }
+
+        std::string temp_path;
+        int fd = -1;
+        while (fd < 0)
+        {
+            temp_path = target + ".tmp." + std::to_string(::getpid()) + "." + std::to_string(sequence++);
+            fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+            if (fd < 0 && errno != EEXIST)
+                return false;
+        }
+        if (exists)
+            ::fchmod(fd, st.st_mode & 07777);
+
+        bool result = true;
+        std::size_t written = 0;
+        while (result && written < content.size())
+        {
+            ssize_t size = ::write(fd, content.data() + written, content.size() - written);
+            if (size < 0 && errno == EINTR)
+                continue;
+            result = size > 0;
+            if (result)
+                written += static_cast<std::size_t>(size);
+        }
+        result = result && ::fsync(fd) == 0;
+        result = (::close(fd) == 0) && result;
+
+        if (!result || ::rename(temp_path.c_str(), target.c_str()) != 0)
+        {
+            ::unlink(temp_path.c_str());
+            return false;
+        }
+
+        // 名前の変更自体を永続化するため、ディレクトリもfsyncする。
+        const std::size_t slash = target.find_last_of('/');
+        const std::string directory = (slash == std::string::npos) ? "." : (slash == 0 ? "/" : target.substr(0, slash));
+        int directory_fd = ::open(directory.c_str(), O_RDONLY);
+        if (directory_fd >= 0)
+        {
+            ::fsync(directory_fd);
+            ::close(directory_fd);
+        }
+        return true;
+#endif
+    }
+
+    struct Splice
+    {
+        std::size_t pos;
+        std::size_t len;
+        const std::string* value;
+    };
+
+    struct FilePatch
+    {
+        std::size_t offset;
+        const char* data;
+        std::size_t size;
+    };
+
+    /**
+     * @fn patch_file
+     * @brief ファイルの指定範囲のみを書き換えるメソッド
+     * @param std::size_t file_size 書換後のファイルサイズ(元のサイズより小さい場合は切り詰める)
+     * @note 書換後にfsyncを行う。@ref write_file と異なり不可分には置き換えない。
+     */
+    bool patch_file(const std::vector<FilePatch>& patches, const std::size_t file_size) const
+    {
+        record(Instrumentation::WRITES);
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(file_path_.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        bool result = true;
+        for (std::size_t i = 0; result && i < patches.size(); ++i)
+        {
+            LARGE_INTEGER offset;
+            offset.QuadPart = static_cast<LONGLONG>(patches[i].offset);
+            result = SetFilePointerEx(file, offset, nullptr, FILE_BEGIN) != 0;
+            std::size_t written = 0;
+            while (result && written < patches[i].size)
+            {
+                DWORD size = 0;
+                const DWORD chunk = static_cast<DWORD>(std::min<std::size_t>(patches[i].size - written, 0x40000000));
+                result = WriteFile(file, patches[i].data + written, chunk, &size, nullptr) != 0;
+                written += size;
+            }
+        }
+        if (result)
+        {
+            LARGE_INTEGER size;
+            size.QuadPart = static_cast<LONGLONG>(file_size);
+            result = SetFilePointerEx(file, size, nullptr, FILE_BEGIN) != 0 && SetEndOfFile(file) != 0;
+        }
+        result = result && FlushFileBuffers(file) != 0;
+        CloseHandle(file);
+        return result;
+#else
+        int fd = ::open(file_path_.c_str(), O_WRONLY);
+        if (fd < 0)
+            return false;
+
+        bool result = true;
+        for (std::size_t i = 0; result && i < patches.size(); ++i)
+        {
+            std::size_t written = 0;
+            while (result && written < patches[i].size)
+            {
+                ssize_t size = ::pwrite(fd, patches[i].data + written, patches[i].size - written, static_cast<off_t>(patches[i].offset + written));
+                if (size < 0 && errno == EINTR)
+                    continue;
+                result = size > 0;
+                if (result)
+                    written += static_cast<std::size_t>(size);
+            }
+        }
+        struct stat st;
+        result = result && ::fstat(fd, &st) == 0;
+        if (result && static_cast<std::size_t>(st.st_size) != file_size)
+            result = ::ftruncate(fd, static_cast<off_t>(file_size)) == 0;
+        result = result && ::fsync(fd) == 0;
+        result = (::close(fd) == 0) && result;
+        return result;
+#endif
+    }
+
+    /**
+     * @fn patch_fields
+     * @brief 既存フィールドの値の範囲のみをファイル上で書き換えるメソッド
+     * @param bool result 書き換えた場合の成否
+     * @return bool 書き換えを行った場合はtrue、全体の書込が必要な場合は何もせずfalseを返却する。
+     * @note 値の長さが全て変わらない場合は各値の範囲のみを、変わる場合は最初の書換位置以降を書き込む。
+     *       位置情報は保持しているドキュメントがファイルと一致する場合はそれを、一致しない場合はファイルを読み込んで求める。
+     */
+    bool patch_fields(const std::vector<FieldUpdate>& updates, bool& result) const
+    {
+        // 圧縮したファイルは値の範囲のみを書き換えられない。
+        if (is_compressed_output(file_path_) || is_compressed_input(file_path_))
+            return false;
+
+        std::shared_ptr<const Document> document = document_.load();
+        if (document && document->buffer->is_mapped() && !document->compiled)
+            return false;
+
+        std::shared_ptr<const Document> source = complete_document(document);
+        const FileStamp stamp = FileStamp::of(file_path_);
+        if (!stamp.exists)
+            return false;
+        if (!source || source->compiled || source->buffer->unsaved || !(source->buffer->stamp == stamp))
+        {
+            std::shared_ptr<Buffer> buffer = make_node<Buffer>(memory_resource_);
+            buffer->stamp = stamp;
+            if (!read_file(*buffer))
+                return false;
+            source = parse_document(std::move(buffer));
+        }
+
+        std::vector<Splice> splices;
+        if (!collect_splices(*source, updates, splices))
+            return false;
+
+        // 不正な行以降のフィールドはドキュメントに登録されないため、全体を書き込む場合と同じく書込失敗とするよう委ねる。
+        struct Validator
+        {
+            bool on_section(const char*, const Document::Span&) { return true; }
+            bool on_field(const char*, const Document::Span&, const Document::Span&) { return true; }
+            bool on_comment(const char*, const Document::Span&) { return true; }
+        };
+        Validator validator;
+        bool has_section = false;
+        std::size_t consumed;
+        if (!scan_lines(parse_rules(), source->data, source->buffer->size(), true, has_section, validator, consumed))
+            return false;
+
+        bool same_length = true;
+        for (const auto& splice : splices)
+            same_length = same_length && splice.len == splice.value->size();
+        const std::string text = splice_text(*source, splices);
+
+        std::vector<FilePatch> patches;
+        if (same_length)
+        {
+            for (const auto& splice : splices)
+            {
+                FilePatch patch = { splice.pos, text.data() + splice.pos, splice.len };
+                patches.push_back(patch);
+            }
+        }
+        else
+        {
+            FilePatch patch = { splices.front().pos, text.data() + splices.front().pos, text.size() - splices.front().pos };
+            patches.push_back(patch);
+        }
 
-    /**
-     * @fn set_comment_prefix_list
-     * @brief コメント行の先頭文字列指定メソッド
-     * @param std::vector<std::string> コメント行の先頭文字列(複数指定可能)
-     * @return Ini& コメント行の先頭文字列変更後のパーサインスタンス
-     * @note インスタンス生成時のデフォルトコメント行の先頭文字列は{ "#", ";" }としている。
-     */
-    Ini& set_comment_prefix_list(const std::vector<std::string>& comment_prefix_list)
-    {
-        comment_prefix_list_ = comment_prefix_list;
-        return *this;
+        result = patch_file(patches, text.size());
+        if (result && document)
+        {
+            std::shared_ptr<Buffer> buffer = make_buffer(text);
+            buffer->stamp = FileStamp::of(file_path_);
+            document_.store(is_plain_values(splices) ? rebase_document(*source, std::move(buffer), splices) : make_document(std::move(buffer)));
+        }
+        return true;
     }
 
     /**
-     * @fn read_bool
-     * @brief 真理値取得メソッド
-     * @param std::string section_name []で囲まれたセクション名
-     * @param std::string field_name 取得したいフィールド名
-     * @param bool default_value 読取失敗時のデフォルト値
-     * @return bool 読取成功時は読み取った値を、失敗した場合はデフォルト値を返却する。
-     * @note 真理値を表現文字列としては "true" もしくは "false" とする。(大文字/小文字は問わない。)
+     * @fn collect_splices
+     * @brief 書込対象の各フィールドの値の範囲を位置順に求めるメソッド
+     * @return bool 書込対象に存在しないフィールドを含む場合、もしくは書込対象が空の場合はfalseを返却する。
+     * @note 全体を書き込む場合と同一の内容となるよう、同一のセクション・フィールド(セクション行の重複を含む)が
+     *       複数回現れる場合は全ての値の範囲を書き換える。同一のフィールドへの書込は最後の値を反映する。
      */
-    bool read_bool(const std::string& section_name, const std::string& field_name, const bool& default_value) const
+    static bool collect_splices(const Document& source, const std::vector<FieldUpdate>& updates, std::vector<Splice>& splices)
     {
-        std::string str;
-        if (!try_get_field(section_name, field_name, str))
-            return default_value;
+        std::unordered_multimap<std::uint64_t, const FieldUpdate*> by_hash;
+        for (const auto& update : updates)
+        {
+            const std::uint64_t hash = hash_key(update.section, update.field);
+            if (source.find(update.section, update.field, hash) == nullptr)
+                return false;
+            by_hash.emplace(hash, &update);
+        }
+        if (by_hash.empty())
+            return false;
 
-        std::transform(str.begin(), str.end(), str.begin(), [](const char c){ 
-                return static_cast<char>(::toupper(c)); 
+        // entries はファイル上の出現順のため、求めた範囲は位置順となる。
+        for (const auto& entry : source.entries)
+        {
+            const FieldUpdate* latest = nullptr;
+            auto range = by_hash.equal_range(entry.hash);
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                const FieldUpdate& update = *it->second;
+                if (source.equals(entry.section, update.section) && source.equals(entry.field, update.field) && (latest == nullptr || latest < &update))
+                    latest = &update;
             }
-        );
-
-        if (str == "TRUE" || str == "1")
-            return true;
-        else if (str == "FALSE" || str == "0")
-            return false;
-        else
-            return default_value;
+            if (latest == nullptr)
+                continue;
+            Splice splice = { entry.value.pos, entry.value.len, &latest->value };
+            splices.push_back(splice);
+        }
+        return true;
     }
 
     /**
-     * @fn read_int
-     * @brief 整数値取得メソッド
-     * @param std::string section_name []で囲まれたセクション名
-     * @param std::string field_name 取得したいフィールド名
-     * @param int default_value 読取失敗時のデフォルト値
-     * @return int 読取成功時は読み取った値を、失敗した場合はデフォルト値を返却する。
+     * @fn splice_text
+     * @brief ドキュメントの内容の各値の範囲を書き換えた内容の生成メソッド
      */
-    int read_int(const std::string& section_name, const std::string& field_name, const int& default_value) const
+    static std::string splice_text(const Document& source, const std::vector<Splice>& splices)
     {
-        std::string str;
-        if (!try_get_field(section_name, field_name, str))
-            return default_value;
-
-        if (!is_convertable_to_long(str))
-            return default_value;
+        const char* data = source.data;
+        const std::size_t size = source.buffer->size();
+        std::size_t new_size = size;
+        for (const auto& splice : splices)
+            new_size = new_size - splice.len + splice.value->size();
 
-        try
+        std::string text;
+        text.reserve(new_size);
+        std::size_t cursor = 0;
+        for (const auto& splice : splices)
         {
-            auto value = std::stol(str);
-            return value;
+            text.append(data + cursor, splice.pos - cursor);
+            text.append(*splice.value);
+            cursor = splice.pos + splice.len;
         }
-        catch (...)
+        text.append(data + cursor, size - cursor);
+        return text;
+    }
+
+    /**
+     * @fn is_plain_values
+     * @brief 書換後の値が解析時の値の範囲と一致する(前後の空白・改行を含まない)かどうかの判定メソッド
+     */
+    static bool is_plain_values(const std::vector<Splice>& splices)
+    {
+        for (const auto& splice : splices)
         {
-            return default_value;
+            const std::string& value = *splice.value;
+            if (value.find('\n') != std::string::npos)
+                return false;
+            if (!value.empty() && (is_whitespace(value.front()) || is_whitespace(value.back())))
+                return false;
         }
+        return true;
     }
 
     /**
-     * @fn read_double
-     * @brief 浮動小数点値取得メソッド
-     * @param std::string section_name []で囲まれたセクション名
-     * @param std::string field_name 取得したいフィールド名
-     * @param double default_value 読取失敗時のデフォルト値
-     * @return double 読取成功時は読み取った値を、失敗した場合はデフォルト値を返却する。
-     */ 
-    double read_double(const std::string& section_name, const std::string& field_name, const double& default_value) const
+     * @fn rebase_document
+     * @brief 値の範囲のみを書き換えた内容に対し、書換前のドキュメントの位置情報をずらして新たなドキュメントを生成するメソッド
+     * @note 行の構成は変わらないため、再度の解析・ハッシュ値の算出・索引の構築を行わない。
+     */
+    std::shared_ptr<const Document> rebase_document(const Document& source, std::shared_ptr<const Buffer> buffer, const std::vector<Splice>& splices) const
     {
-        std::string str;
-        if (!try_get_field(section_name, field_name, str))
-            return default_value;
-            
-        try
+        std::shared_ptr<Document> document = make_node<Document>(memory_resource_);
+        document->data = buffer->data();
+        document->buffer = std::move(buffer);
+
+        // shifts[i] は splices[i] より後ろの位置に加算するずれ量とする。
+        std::vector<std::ptrdiff_t> shifts(splices.size());
+        std::ptrdiff_t shift = 0;
+        for (std::size_t i = 0; i < splices.size(); ++i)
         {
-            auto value = std::stod(str);
-            return value;
+            shift += static_cast<std::ptrdiff_t>(splices[i].value->size()) - static_cast<std::ptrdiff_t>(splices[i].len);
+            shifts[i] = shift;
         }
-        catch (...)
+        auto rebase = [&](Document::Span& span)
         {
-            return default_value;
+            auto it = std::lower_bound(splices.begin(), splices.end(), span.pos, [](const Splice& splice, const std::size_t pos) { return splice.pos < pos; });
+            if (it != splices.end() && it->pos == span.pos && span.len == it->len)
+                span.len = it->value->size();
+            if (it != splices.begin())
+                span.pos = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(span.pos) + shifts[static_cast<std::size_t>(it - splices.begin()) - 1]);
+        };
+
+        document->entry_storage.assign(source.entries.begin(), source.entries.end());
+        for (auto& entry : document->entry_storage)
+        {
+            rebase(entry.section);
+            rebase(entry.field);
+            rebase(entry.value);
         }
+        document->slot_storage.assign(source.slots.begin(), source.slots.end());
+        document->section_storage.assign(source.sections.begin(), source.sections.end());
+        for (auto& section : document->section_storage)
+            rebase(section.name);
+        document->section_slot_storage.assign(source.section_slots.begin(), source.section_slots.end());
+        document->attach();
+        return document;
     }
 
-    /**
-     * @fn read_str
-     * @brief 文字列取得メソッド
-     * @param std::string section_name []で囲まれたセクション名
-     * @param std::string field_name 取得したいフィールド名
-     * @param std::string default_value 読取失敗時のデフォルト値
-     * @return std::string 読取成功時は読み取った値を、失敗した場合はデフォルト値を返却する。
-     */ 
-    std::string read_str(const std::string& section_name, const std::string& field_name, const std::string& default_value) const
+    static std::string format_bool(const bool& value)
     {
-        std::string str;
-        if (!try_get_field(section_name, field_name, str))
-            return default_value;
-        return std::string(str);
+        return value ? "true" : "false";
     }
 
-    /**
-     * @fn write_bool
-     * @brief 真理値書込メソッド
-     * @param std::string section_name []で囲まれたセクション名
-     * @param std::string field_name 取得したいフィールド名
-     * @param bool value 書込値
-     * @note 既に対象のセクション・フィールドが存在していた場合上書きする。
-     */
-    bool write_bool(const std::string& section_name, const std::string& field_name, const bool &value) const
+    static std::string format_int(const int& value)
     {
-        std::string result = value ? "true" : "false";
-        return set_field(section_name, field_name, result);
+        char buffer[16];
+#if INI_HAS_CHARCONV
+        std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        return std::string(buffer, result.ptr);
+#else
+        int size = std::snprintf(buffer, sizeof(buffer), "%d", value);
+        return std::string(buffer, static_cast<std::size_t>(size));
+#endif
     }
 
     /**
-     * @fn write_int
-     * @brief 整数値書込メソッド
-     * @param std::string section_name []で囲まれたセクション名
-     * @param std::string field_name 取得したいフィールド名
-     * @param int value 書込値
-     * @note 既に対象のセクション・フィールドが存在していた場合上書きする。
+     * @fn format_double
+     * @brief 浮動小数点値の文字列化メソッド
+     * @note std::ostream の既定書式と同じく有効桁数6桁の %g 形式とする。
      */
-    bool write_int(const std::string& section_name, const std::string& field_name, const int& value) const
+    static std::string format_double(const double& value)
+    {
+        char buffer[32];
+#if INI_HAS_CHARCONV_FLOAT
+        std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, 6);
+        return std::string(buffer, result.ptr);
+#else
+        int size = std::snprintf(buffer, sizeof(buffer), "%g", value);
+        return std::string(buffer, static_cast<std::size_t>(size));
+#endif
+    }
+
+    bool set_field(const std::string& target_section, const std::string& target_field, const std::string& value) const
     {
-        std::stringstream ss;
-        ss << value;
-        return set_field(section_name, field_name, ss.str());
+        FieldUpdate update = { target_section, target_field, value };
+        return commit_fields(std::vector<FieldUpdate>(1, std::move(update)));
     }
 
     /**
-     * @fn write_double
-     * @brief 浮動小数点値書込メソッド
-     * @param std::string section_name []で囲まれたセクション名
-     * @param std::string field_name 取得したいフィールド名
-     * @param double value 書込値
-     * @note 既に対象のセクション・フィールドが存在していた場合上書きする。
+     * @fn commit_fields
+     * @brief 複数フィールドの書込を反映するメソッド
+     * @note 遅延書込を指定している場合はメモリ上のドキュメントのみに反映し、ファイルへの書込は @ref flush に委ねる。
      */
-    bool write_double(const std::string& section_name, const std::string& field_name, const double& value) const
+    bool commit_fields(const std::vector<FieldUpdate>& updates) const
     {
-        std::stringstream ss;
-        ss << value;
-        return set_field(section_name, field_name, ss.str());
+        std::lock_guard<Mutex> lock(write_mutex_);
+        const bool result = (write_behind_interval_.count() != 0) ? stage_fields(updates) : write_fields(updates);
+        if (result && !published_name_.empty())
+            publish_document();
+        return result;
     }
 
     /**
-     * @fn write_double
-     * @brief 浮動小数点値書込メソッド
-     * @param std::string section_name []で囲まれたセクション名
-     * @param std::string field_name 取得したいフィールド名
-     * @param std::string value 書込値
-     * @note 既に対象のセクション・フィールドが存在していた場合上書きする。
+     * @fn flush_dirty
+     * @brief ファイルへ未反映の書込内容を書き込むメソッド
+     * @note write_mutex_ を取得した状態で呼び出すこと。失敗した場合は書込内容を保持する。
      */
-    bool write_str(const std::string& section_name, const std::string& field_name, const std::string& value) const
+    bool flush_dirty() const
     {
-        return set_field(section_name, field_name, value);
+        if (dirty_.empty())
+            return true;
+        if (!write_fields(dirty_))
+            return false;
+        dirty_.clear();
+        dirty_index_.clear();
+        dirty_count_ = 0;
+        return true;
     }
 
-private:
-    std::string file_path_;
-    char field_separator_;
-    std::vector<std::string> comment_prefix_list_;
-
-    void trim(std::string& str) const
+    /**
+     * @fn stage_fields
+     * @brief 複数フィールドの書込をメモリ上のドキュメントに反映し、ファイルへ未反映の書込として蓄積するメソッド
+     * @note ドキュメントを保持していない場合は読み込んだ上で反映する。同一のセクション・フィールドへの書込は
+     *       最初の登録位置に最後の値をまとめる。
+     */
+    bool stage_fields(const std::vector<FieldUpdate>& updates) const
     {
-        const char *whitespaces = " \t\n\r\f\v";
-        auto lascurrent_tpos = str.find_last_not_of(whitespaces);
-        if (lascurrent_tpos == std::string::npos)
+        std::shared_ptr<const Document> source = document_.load();
+        if (!source || source->compiled)
         {
-            str.clear();
-            return;
+            load_document();
+            source = document_.load();
         }
-        str.erase(lascurrent_tpos + 1);
-        str.erase(0, str.find_first_not_of(whitespaces));
+        std::shared_ptr<const Document> document = overlay_document(*complete_document(source), updates);
+        if (!document)
+            return false;
+        document_.store(std::move(document));
+
+        for (const auto& update : updates)
+        {
+            const std::uint64_t hash = hash_key(update.section, update.field);
+            auto range = dirty_index_.equal_range(hash);
+            auto it = range.first;
+            for (; it != range.second; ++it)
+            {
+                const FieldUpdate& other = dirty_[it->second];
+                if (other.section == update.section && other.field == update.field)
+                    break;
+            }
+
+            if (it != range.second)
+            {
+                dirty_[it->second].value = update.value;
+                continue;
+            }
+            dirty_index_.emplace(hash, dirty_.size());
+            dirty_.push_back(update);
+        }
+
+        dirty_count_ += updates.size();
+        flusher_.start(*this, write_behind_interval_);
+        if (write_behind_limit_ != 0 && dirty_count_ >= write_behind_limit_)
+            flusher_.request();
+        return true;
     }
 
-    bool is_convertable_to_long(const std::string& value) const
+    /**
+     * @fn overlay_document
+     * @brief ドキュメントの内容に複数フィールドの書込を反映した新たなドキュメントを生成するメソッド
+     * @return std::shared_ptr<const Document> 不正な行を含み反映できない場合はnullptrを返却する。
+     * @note 既存フィールドの値のみを書き換える場合は @ref rebase_document により再度の解析を行わない。
+     *       生成したドキュメントはsourceと同じファイルの更新日時・サイズを保持し、ファイルへ未反映である旨を記録する。
+     */
+    std::shared_ptr<const Document> overlay_document(const Document& source, const std::vector<FieldUpdate>& updates) const
     {
-        char *endptr;
-        long result;
-        result = std::strtol(value.c_str(), &endptr, 10);
-        if (*endptr == '\0')
-            return true;
-        result = std::strtol(value.c_str(), &endptr, 8);
-        if (*endptr == '\0')
-            return true;
-        result = std::strtol(value.c_str(), &endptr, 16);
-        if (*endptr == '\0')
-            return true;
-        return false;
+        std::vector<Splice> splices;
+        const bool plain = collect_splices(source, updates, splices) && is_plain_values(splices);
+
+        std::string text;
+        if (plain)
+            text = splice_text(source, splices);
+        else if (!render_fields(source.data, source.buffer->size(), updates, text))
+            return nullptr;
+
+        std::shared_ptr<Buffer> buffer = make_buffer(text);
+        buffer->stamp = source.buffer->stamp;
+        buffer->unsaved = true;
+        return plain ? rebase_document(source, std::move(buffer), splices) : parse_document(std::move(buffer));
     }
 
-    bool is_ignore_line(const std::string& line) const
+    /**
+     * @fn write_fields
+     * @brief 複数フィールドの書込をファイルの読込・再構築・書込それぞれ一度で反映するメソッド
+     * @note 既存フィールドはその行を置き換え、既存セクションに無いフィールドはそのセクションの末尾に、
+     *       存在しないセクションはファイルの末尾に追加する。
+     */
+    bool write_fields(const std::vector<FieldUpdate>& updates) const
     {
-        if (line.size() == 0)
-            return true;
+        const Stopwatch stopwatch(*this, Instrumentation::COMMIT);
 
-        for (const auto &prefix : comment_prefix_list_)
+        bool patched;
+        if (in_place_write_ && patch_fields(updates, patched))
+            return patched;
+
+        // ファイルが存在しない場合は新たに作成し、読込に失敗した場合は途中までの内容で置き換えないよう書き込まない。
+        std::string text;
+        if (!read_file(text) && FileStamp::of(file_path_).exists)
+            return false;
+        std::string oss;
+        if (!render_fields(text.data(), text.size(), updates, oss))
+            return false;
+
+        std::shared_ptr<const Document> document = document_.load();
+        bool mapped = false;
+#if defined(_WIN32)
+        // Windowsではマップ中のファイルを置き換えられないため、書込前にマップを解放する。
+        mapped = document && document->buffer->is_mapped();
+        if (mapped)
         {
-            std::size_t pos = line.find(prefix);
-            if (pos == 0)
-                return true;
+            document.reset();
+            document_.store(nullptr);
         }
+#endif
 
-        return false;
-    }
+        if (!write_file(oss))
+        {
+            if (mapped)
+                document_.store(make_document(make_buffer(text)));
+            return false;
+        }
 
-    bool try_get_field(const std::string& target_section, const std::string& target_field, std::string& value) const
-    {
-        std::stringstream iss;
-        std::ifstream ifs(file_path_);
-        iss << ifs.rdbuf();
+        if (document || mapped)
+        {
+            std::shared_ptr<Buffer> buffer = make_buffer(oss);
+            buffer->stamp = FileStamp::of(file_path_);
+            document_.store(make_document(std::move(buffer)));
+        }
 
-        int line_num = 0;
-        std::string current_section = "";
-        std::string line;
+        return true;
+    }
 
-        while (!iss.eof() && !iss.fail())
+    /**
+     * @fn render_fields
+     * @brief [data, data + size) の内容に複数フィールドの書込を反映した内容をossへ生成するメソッド
+     * @return bool 不正な行を検出した場合はfalseを返却する。
+     */
+    bool render_fields(const char* data, const std::size_t size, const std::vector<FieldUpdate>& updates, std::string& oss) const
+    {
+        struct Pending
         {
-            std::getline(iss, line, '\n');
-            trim(line);
-            ++line_num;
-
-            if (is_ignore_line(line))
-                continue;
+            const FieldUpdate* update;
+            bool written;
+        };
 
-            if (line[0] == '[')
+        // 同一のセクション・フィールドへの書込は最初の登録位置に最後の値をまとめる。
+        std::vector<Pending> pending;
+        std::unordered_multimap<std::uint64_t, std::size_t> by_field, by_section;
+        for (const auto& update : updates)
+        {
+            const std::uint64_t hash = hash_key(update.section, update.field);
+            auto range = by_field.equal_range(hash);
+            auto it = range.first;
+            for (; it != range.second; ++it)
             {
-                std::size_t pos = line.find("]");
-                if (pos == std::string::npos)
-                    return false;
-                if (pos == 1)
-                    return false;
-                current_section = line.substr(1, pos - 1);
+                const FieldUpdate& other = *pending[it->second].update;
+                if (other.section == update.section && other.field == update.field)
+                    break;
             }
-            else
-            {
-                if (current_section == "")
-                    return false;
 
-                std::size_t pos = line.find(field_separator_);
+            if (it != range.second)
+            {
+                pending[it->second].update = &update;
+                continue;
+            }
 
-                if (pos == std::string::npos)
-                {
-                    return false;
-                }
-                else
-                {
-                    std::string current_field = line.substr(0, pos);
-                    trim(current_field);
-                    std::string current_value = line.substr(pos + 1, std::string::npos);
-                    trim(current_value);
+            by_field.emplace(hash, pending.size());
+            by_section.emplace(hash_section(update.section), pending.size());
+            pending.push_back({ &update, false });
+        }
 
-                    if (current_section == target_section && current_field == target_field)
-                    {
-                        value = current_value;
-                        return (value.size() != 0) ? true : false;
-                    }
-                }
+        auto find_pending = [&](const StringRef& section, const StringRef& field) -> Pending*
+        {
+            auto range = by_field.equal_range(hash_key(section, field));
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                Pending& candidate = pending[it->second];
+                if (section.equals(candidate.update->section) && field.equals(candidate.update->field))
+                    return &candidate;
             }
-        }
-        return false;
-    }
+            return nullptr;
+        };
 
-    bool set_field(const std::string& target_section, const std::string& target_field, const std::string& value) const
-    {
-        std::stringstream iss, oss;
-        std::ifstream ifs(file_path_);
-        iss << ifs.rdbuf();
+        auto append_field = [&](Pending& candidate)
+        {
+            oss.append(candidate.update->field);
+            oss.push_back(field_separator_);
+            oss.append(candidate.update->value);
+            oss.push_back('\n');
+            candidate.written = true;
+        };
 
-        enum struct FoundMode { NO_MATCH, SECTION_MATCH, BOTH_MATCH };
-        FoundMode found_mode = FoundMode::NO_MATCH;
+        // 対象セクションを抜ける時点で未反映のフィールドをセクション末尾へ追加する。
+        auto flush_section = [&](const StringRef& section)
+        {
+            std::vector<std::size_t> indices;
+            auto range = by_section.equal_range(hash_section(section));
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                if (!pending[it->second].written && section.equals(pending[it->second].update->section))
+                    indices.push_back(it->second);
+            }
+            std::sort(indices.begin(), indices.end());
+            for (auto index : indices)
+                append_field(pending[index]);
+        };
 
-        int line_num = 0;
-        std::string current_section = "";
-        std::string line;
+        oss.reserve(size + updates.size() * 32);
+        record_lines(data, data + size);
+        bool has_section = false;
+        Document::Span current_section = { 0, 0 };
 
-        // iterate file line by line
-        while (!iss.eof() && !iss.fail())
+        std::size_t begin = 0;
+        while (size != 0 && begin <= size)
         {
-            std::getline(iss, line, '\n');
-            trim(line);
-            ++line_num;
+            std::size_t end = static_cast<std::size_t>(Scanner::find(data + begin, data + size, '\n') - data);
+            Document::Span line = { begin, end - begin };
+            begin = end + 1;
+            trim(data, line);
 
-            if (is_ignore_line(line))
+            if (is_ignore_line(data, line))
             {
-                oss << line << '\n';
+                oss.append(data + line.pos, line.len);
+                oss.push_back('\n');
                 continue;
             }
 
-            if (line[0] == '[')
+            if (data[line.pos] == '[')
             {
-                std::size_t pos = line.find("]");
-                if (pos == std::string::npos)
+                const char* close = Scanner::find(data + line.pos, data + line.pos + line.len, ']');
+                if (close == data + line.pos + line.len)
                     return false;
+                std::size_t pos = static_cast<std::size_t>(close - (data + line.pos));
                 if (pos == 1)
                     return false;
-                current_section = line.substr(1, pos - 1);
 
-                if (current_section == target_section)
-                    found_mode = FoundMode::SECTION_MATCH;
-                else if (found_mode == FoundMode::SECTION_MATCH && current_section != target_section)
-                {
-                    line = target_field + field_separator_ + value + '\n' + line;
-                    found_mode = FoundMode::BOTH_MATCH;
-                }
+                StringRef next_section(data + line.pos + 1, pos - 1);
+                if (has_section && !next_section.equals(data + current_section.pos, current_section.len))
+                    flush_section(StringRef(data + current_section.pos, current_section.len));
+
+                current_section.pos = line.pos + 1;
+                current_section.len = pos - 1;
+                has_section = true;
+                oss.append(data + line.pos, line.len);
             }
             else
             {
-                if (current_section=="")
+                if (!has_section)
                     return false;
 
-                std::size_t pos = line.find(field_separator_);
-                if (pos==std::string::npos)
+                const char* separator = Scanner::find(data + line.pos, data + line.pos + line.len, field_separator_);
+                if (separator == data + line.pos + line.len)
                     return false;
 
-                else
+                Document::Span field = { line.pos, static_cast<std::size_t>(separator - data) - line.pos };
+                trim(data, field);
+                Pending* candidate = find_pending(StringRef(data + current_section.pos, current_section.len), StringRef(data + field.pos, field.len));
+                if (candidate != nullptr)
                 {
-                    std::string current_field = line.substr(0, pos);
-                    trim(current_field);
-                    if (current_section == target_section && current_field == target_field)
-                    {
-                        line = std::string(target_field.c_str()) + field_separator_ + value;
-                        found_mode = FoundMode::BOTH_MATCH;
-                    }
+                    append_field(*candidate);
+                    continue;
                 }
+                oss.append(data + line.pos, line.len);
             }
-            oss << line << '\n';
+            oss.push_back('\n');
         }
 
-        if (found_mode == FoundMode::NO_MATCH)
-        {
-            oss << '[' << target_section << ']' << '\n';
-            oss << target_field << field_separator_ << value << '\n';
-        }
-        else if (found_mode == FoundMode::SECTION_MATCH)
+        if (has_section)
+            flush_section(StringRef(data + current_section.pos, current_section.len));
+
+        // 存在しなかったセクションは登録順にファイル末尾へ追加する。
+        for (auto& candidate : pending)
         {
-            oss << target_field << field_separator_ << value << '\n';
+            if (candidate.written)
+                continue;
+            oss.push_back('[');
+            oss.append(candidate.update->section);
+            oss.push_back(']');
+            oss.push_back('\n');
+            flush_section(candidate.update->section);
         }
 
-        std::string result = oss.str();
-        result.pop_back();
-
-        std::ofstream ofs(file_path_);
-        if(ofs.is_open())
-            ofs << result;
-        else
-            return false;
-        
+        if (!oss.empty())
+            oss.pop_back();
         return true;
     }
 };
 
+namespace std
+{
+    /// @ref Ini::Symbol を非順序連想コンテナのキーとして用いるためのハッシュ
+    template <>
+    struct hash<Ini::Symbol>
+    {
+        std::size_t operator()(const Ini::Symbol& symbol) const
+        {
+            return std::hash<std::uint32_t>()(symbol.id());
+        }
+    };
+}
+
 #endif
\ No newline at end of file